@@ -1,13 +1,36 @@
 #pragma once
 
+#include <iostream>
 #include <shared_mutex>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <set>
 #include <chrono>
 #include <functional>
 #include <typeindex>
 #include <cassert>
+#include <span>
+#include <ranges>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <atomic>
+#include <bitset>
+#include <mutex>
+#include <optional>
+#include <array>
+#include <limits>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifndef VECS_MAX_TYPES
+#define VECS_MAX_TYPES 256 //number of dense IDs for component types and tags, the width of archetype signatures
+#endif
 
 namespace vecs {
 
@@ -35,12 +58,140 @@ namespace vecs {
 	template<typename... Ts>
 	struct No {};
 
-	/// @brief Turn a type into a hash.
+	/// @brief Turn a type into a hash. The hash is computed once per type and cached.
 	/// @tparam T The type to hash.
 	/// @return The hash of the type.
 	template<typename T>
 	inline auto Type() -> std::size_t {
-		return std::type_index(typeid(T)).hash_code();
+		static const std::size_t hash = std::type_index(typeid(T)).hash_code();
+		return hash;
+	}
+
+	inline constexpr std::size_t NO_ID = std::numeric_limits<std::size_t>::max(); ///< ID of a type or tag that has none.
+
+	/// @brief Hands out dense IDs for component types and tags, shared by all registries. 
+	/// Types are identified by their hash, tags by their value. Only adding a component or a tag to an entity hands out IDs,
+	/// queries look them up with Find(), so testing for tags does not use up the VECS_MAX_TYPES IDs.
+	/// If the IDs run out, AddTags() fails, while a new component type ends the program, see TypeId().
+	struct TypeIds {
+		inline static std::atomic<std::size_t> m_next{0}; ///< Next free type ID, also the number of IDs handed out.
+		inline static Mutex_t m_mutex; ///< Protects m_ids.
+		inline static std::unordered_map<std::size_t, std::size_t> m_ids; ///< Map from type hash or tag to ID.
+
+		/// @brief Get the ID of a type hash or tag, hand out a new ID if it has none yet.
+		/// @param key Type hash or tag.
+		/// @return The ID, or NO_ID if all VECS_MAX_TYPES IDs are used up.
+		static auto Get(std::size_t key) -> std::size_t {
+			if( auto id = Find(key); id != NO_ID ) { return id; }
+			std::unique_lock lock(m_mutex);
+			if( auto it = m_ids.find(key); it != m_ids.end() ) { return it->second; }
+			if( m_next.load() >= VECS_MAX_TYPES ) {
+				assert(false && "More than VECS_MAX_TYPES component types and tags, define VECS_MAX_TYPES larger!");
+				return NO_ID;
+			}
+			m_ids.emplace(key, m_next.load());
+			return m_next++;
+		}
+
+		/// @brief Look up the ID of a type hash or tag without handing out a new one.
+		/// @param key Type hash or tag.
+		/// @return The ID, or NO_ID if the key has none.
+		static auto Find(std::size_t key) -> std::size_t {
+			std::shared_lock lock(m_mutex);
+			auto it = m_ids.find(key);
+			return it != m_ids.end() ? it->second : NO_ID;
+		}
+	};
+
+	using Signature_t = std::bitset<VECS_MAX_TYPES>; ///< Set of type IDs, e.g. the component types and tags of an archetype.
+
+	/// @brief Get the dense ID of a type. IDs are 0, 1, 2, ... in the order in which types are first used,
+	/// so they can index arrays and bitsets. Like Type<T>(), cv-qualifiers and references are ignored.
+	/// Component types are fixed at compile time, so running out of IDs is a configuration error and ends the program,
+	/// also in release builds. Otherwise signatures could not hold the type.
+	/// @tparam T The type.
+	/// @return The ID of the type.
+	template<typename T>
+	inline auto TypeId() -> std::size_t {
+		if constexpr (!std::is_same_v<T, std::remove_cvref_t<T>>) {
+			return TypeId<std::remove_cvref_t<T>>();
+		} else {
+			static const std::size_t id = []() {
+				auto id = TypeIds::Get(Type<T>());
+				if (id == NO_ID) {
+					std::cout << "More than VECS_MAX_TYPES = " << VECS_MAX_TYPES << " component types and tags, define VECS_MAX_TYPES larger!" << std::endl;
+					exit(-1);
+				}
+				return id;
+			}();
+			return id;
+		}
+	}
+
+	/// @brief Get the dense ID of a tag, hand out a new ID if it has none yet. Tags share the IDs with component types.
+	/// @param tag The tag.
+	/// @return The ID of the tag, or NO_ID if all IDs are used up.
+	inline auto TagId(std::size_t tag) -> std::size_t {
+		return TypeIds::Get(tag);
+	}
+
+	/// @brief Get the signature of a list of types.
+	/// @tparam ...Ts The types.
+	/// @return Bitset with the IDs of the types set.
+	template<typename... Ts>
+	inline auto TypeSignature() -> Signature_t {
+		Signature_t signature;
+		(signature.set(TypeId<Ts>()), ...);
+		return signature;
+	}
+
+	/// @brief Get the signature of a list of tags, hand out IDs to new tags.
+	/// @param tags The tags.
+	/// @return Bitset with the IDs of the tags set, or std::nullopt if a tag could not get an ID.
+	inline auto TagSignature(const std::vector<size_t>& tags) -> std::optional<Signature_t> {
+		Signature_t signature;
+		for (auto tag : tags) { 
+			auto id = TagId(tag);
+			if (id == NO_ID) { return std::nullopt; }
+			signature.set(id); 
+		}
+		return signature;
+	}
+
+	/// @brief Get the signature of the known tags of a list, without handing out IDs. Tags without an ID
+	/// are left out, no archetype has them.
+	/// @param tags The tags.
+	/// @return Bitset with the IDs of the known tags set.
+	inline auto FindTagSignature(const std::vector<size_t>& tags) -> Signature_t {
+		Signature_t signature;
+		for (auto tag : tags) { 
+			if (auto id = TypeIds::Find(tag); id != NO_ID) { signature.set(id); }
+		}
+		return signature;
+	}
+
+	/// @brief Hands out dense IDs for type packs, shared by all registries.
+	struct PackIds {
+		inline static std::atomic<std::size_t> m_next{0}; ///< Next free pack ID.
+	};
+
+	/// @brief Get the dense ID of a type pack, e.g. the component types of Insert<Ts...>. The ID is handed out on first use
+	/// and cached. cv-qualifiers and references are ignored, but the order of the types matters.
+	/// @tparam ...Ts The types of the pack.
+	/// @return The ID of the pack.
+	template<typename... Ts>
+	inline auto PackId() -> std::size_t {
+		if constexpr (!(std::is_same_v<Ts, std::remove_cvref_t<Ts>> && ...)) {
+			return PackId<std::remove_cvref_t<Ts>...>();
+		} else {
+			static const std::size_t id = PackIds::m_next++;
+			return id;
+		}
+	}
+
+	/// @brief Number of type IDs handed out so far.
+	inline auto TypeIdCount() -> std::size_t {
+		return TypeIds::m_next.load();
 	}
 
 	/// @brief Compute the hash of a list of hashes. If stored in a vector, make sure that hashes are sorted.
@@ -156,7 +307,7 @@ namespace vecs {
 
 }
 
-#if !defined(REGISTRYTYPE_SEQUENTIAL) || !defined(REGISTRYTYPE_PARALLEL)
+#if !defined(REGISTRYTYPE_SEQUENTIAL) && !defined(REGISTRYTYPE_PARALLEL)
 #define REGISTRYTYPE_SEQUENTIAL
 #endif
 
@@ -168,7 +319,9 @@ using Size_t = std::atomic<std::size_t>;
 
 // Console communication functionality
 namespace vecs {
-	class Registry;
+	template<size_t INDEX_BITS, size_t VERSION_BITS, size_t STORAGE_BITS> struct HandleT;
+	template<typename H> class RegistryT;
+	using Registry = RegistryT<HandleT<32,24,8>>;
 	class VECSConsoleComm;
 	/// @brief Retrieve Console Communication object for a Registry.
 	/// @param reg Registry to connect to Console.
@@ -179,6 +332,7 @@ namespace vecs {
 #include <VTLL.h>
 #include <VSTY.h>
 #include "VECSHandle.h"
+#include "VECSHandleMap.h"
 #include "VECSMutex.h"
 #include "VECSVector.h"
 #include "VECSSlotMap.h"
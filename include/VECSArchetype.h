@@ -9,19 +9,26 @@ namespace vecs {
 	/// All entities that have the same components are stored in the same archetype. 
 	/// The components are stored in the component maps. Note that the archetype class is not templated,
 	/// but some methods including a constructor are templated. Thus the class knows only type indices
-	/// of its components, not the types themselves.
-	class Archetype {
+	/// of its components, not the types themselves. The component maps are stored in a dense array of columns, and a
+	/// table indexed by the dense type ID gives the column of a type, so finding a component map needs no hashing.
+	/// The handle is always in column 0. The component types and tags are kept as a sorted vector of hashes, 
+	/// and as a signature, a bitset over their dense IDs, so testing for a type is a single bit test.
+	/// @tparam H The handle type.
+	template<typename H>
+	class ArchetypeT {
 
 	public:
+		using Handle = H; ///< Type of the handles.
 
 		/// @brief A pair of an archetype and an index. This is stored in the slot map.
 		struct ArchetypeAndIndex {
-			Archetype* m_arch;	//pointer to the archetype
+			ArchetypeT* m_arch;	//pointer to the archetype
 			size_t m_index;			//index of the entity in the archetype
 		};
 
 		/// @brief Constructor, creates the archetype.
-		Archetype() {
+		/// @param pool Segment pool of the registry used by all component maps, or nullptr.
+		ArchetypeT(SegmentPool* pool = nullptr) : m_pool{ pool } {
 			AddComponent<Handle>(); //insert the handle			
 		}
 
@@ -33,22 +40,77 @@ namespace vecs {
 		template<typename... Ts>
 		size_t Insert(Handle handle, Ts&& ...values) {
 			assert(m_maps.size() == sizeof...(Ts) + 1);
-			assert((m_maps.contains(Type<Ts>()) && ...));
+			assert((Column(TypeId<Ts>()) && ...));
 			(AddValue(std::forward<Ts>(values)), ...); //insert all components, get index of the handle
-			return AddValue(handle); //insert the handle
+			size_t index = AddValue(handle); //insert the handle
+			ChunksChanged(index, index + 1, index);
+			return index;
+		}
+
+		/// @brief Insert new entities with components from spans, one span per component. Whole column ranges are appended.
+		/// @tparam ...Ts Value types of the components.
+		/// @param handles The handles of the entities.
+		/// @param ...values The values of the components, each span as long as handles.
+		/// @return The index of the first new entity in the archetype, the others follow.
+		template<typename... Ts>
+		size_t InsertBulk(std::span<const Handle> handles, std::span<const Ts>... values) {
+			assert(m_maps.size() == sizeof...(Ts) + 1);
+			assert(((values.size() == handles.size()) && ...));
+			size_t first = Number();
+			(Map<Ts>()->append(values), ...);
+			Map<Handle>()->append(handles);
+			ChunksChanged(first, first + handles.size(), first);
+			return first;
+		}
+
+		/// @brief Insert new entities with components from a generator.
+		/// @tparam ...Ts Value types of the components.
+		/// @param handles The handles of the entities.
+		/// @param gen Generator called with the number of the entity, returning a std::tuple<Ts...> with its component values.
+		/// @return The index of the first new entity in the archetype, the others follow.
+		template<typename... Ts>
+		size_t InsertBulk(std::span<const Handle> handles, auto&& gen) {
+			assert(m_maps.size() == sizeof...(Ts) + 1);
+			size_t first = Number();
+			auto maps = std::make_tuple(Map<Ts>()...);
+			std::apply([&](auto*... map) { (map->reserve(first + handles.size()), ...); }, maps);
+			for (size_t i = 0; i < handles.size(); ++i) {
+				std::tuple<Ts...> values = gen(i);
+				[&]<size_t... Is>(std::index_sequence<Is...>) { 
+					(std::get<Is>(maps)->push_back(std::move(std::get<Is>(values))), ...); 
+				}(std::index_sequence_for<Ts...>{});
+			}
+			Map<Handle>()->append(handles);
+			ChunksChanged(first, first + handles.size(), first);
+			return first;
 		}
 
 		/// @brief Get referece to the types of the components.
-		/// @return A reference to the container of the types.
+		/// @return A reference to the sorted vector of the type hashes and tags.
 		[[nodiscard]] auto& Types() {
 			return m_types;
 		}
 
-		/// @brief Test if the archetype has a component.
-		/// @param ti Hash of the type index of the component.
+		/// @brief Get the signature of the archetype.
+		/// @return Bitset with the IDs of the component types and tags set.
+		[[nodiscard]] auto Signature() const -> const Signature_t& {
+			return m_signature;
+		}
+
+		/// @brief Test if the archetype has a component or tag. Searches the sorted types of this archetype, 
+		/// so it takes no lock on the shared type IDs.
+		/// @param ti Hash of the type index of the component, or the tag.
 		/// @return true if the archetype has the component, else false.
 		bool Has(const size_t ti) {
-			return m_types.contains(ti);
+			return std::ranges::binary_search(m_types, ti);
+		}
+
+		/// @brief Test if the archetype has a component.
+		/// @tparam T The type of the component.
+		/// @return true if the archetype has the component, else false.
+		template<typename T>
+		bool Has() {
+			return m_signature.test(TypeId<T>());
 		}
 
 		/// @brief Get component value of an entity. 
@@ -58,8 +120,8 @@ namespace vecs {
 		template<typename U>
 		[[nodiscard]] auto Get(size_t archIndex) -> U& {
 			using T = std::decay_t<U>;
-			assert(m_maps.contains(Type<T>()));
-			assert(m_maps[Type<T>()]->size() > archIndex);
+			assert(Column(TypeId<T>()));
+			assert(Column(TypeId<T>())->size() > archIndex);
 			return (*Map<U>())[archIndex]; //Map<U>() decays the type
 		}
 
@@ -70,7 +132,7 @@ namespace vecs {
 		template<typename... Ts>
 			requires (sizeof...(Ts) > 1)
 		[[nodiscard]] auto Get(size_t archIndex) -> std::tuple<Ts&...> {
-			assert((m_maps.contains(Type<Ts>()) && ...));
+			assert((Column(TypeId<Ts>()) && ...));
 			//assert( (m_maps[Type<Ts>()]->size() > archIndex && ...) );
 			return std::tuple<std::decay_t<Ts>&...>{ (*Map<std::decay_t<Ts>>())[archIndex]... };
 		}
@@ -81,9 +143,10 @@ namespace vecs {
 		/// @param ...vs The component values.
 		template<typename... Ts>
 		void Put(size_t archIndex, Ts&& ...vs) {
-			assert((m_maps.contains(Type<Ts>()) && ...));
+			assert((Column(TypeId<Ts>()) && ...));
 			auto fun = [&]<typename T>(T && v) { (*Map<std::decay_t<T>>())[archIndex] = std::forward<T>(v); };
 			(fun.template operator()(std::forward<decltype(vs)>(vs)), ...);
+			if (m_chunks) { ChunksChanged(archIndex, archIndex + 1, Number()); }
 		}
 
 		/// @brief Erase an entity
@@ -93,60 +156,192 @@ namespace vecs {
 			return Erase2(index);
 		}
 
+		/// @brief Erase a number of entities in one sweep. Holes below the new size are filled with the surviving entities 
+		/// from the end, then all columns are cut to the new size. While the archetype is iterated, entities are erased one by one.
+		/// @param indices Indices of the entities, sorted in ascending order without duplicates.
+		/// @param moved Called with the handle and the new index of each entity that was moved into a hole.
+		template<typename F>
+		void EraseBulk(std::span<const size_t> indices, F&& moved) {
+			if (indices.empty()) return;
+			if (m_iteratingArchetype == this) {
+				for (size_t i = indices.size(); i > 0; --i) { moved(Erase2(indices[i - 1]), indices[i - 1]); }
+				return;
+			}
+			size_t number = Number();
+			size_t keep = number - indices.size();
+			auto holes = std::lower_bound(indices.begin(), indices.end(), keep); //holes are before, erased entities at the end after
+			auto doomed = holes;
+			auto hole = indices.begin();
+			for (size_t from = keep; from < number && hole != holes; ++from) {
+				if (doomed != indices.end() && *doomed == from) { ++doomed; continue; }
+				for (auto& map : m_maps) { map->swap(*hole, from); }
+				moved((*Map<Handle>())[*hole], *hole);
+				++hole;
+			}
+			for (auto& map : m_maps) { map->resize(keep); }
+			++m_changeCounter;
+			ChunksChanged(indices.front(), number, number);
+		}
+
+		/// @brief Columns for moving entities from another archetype to this one. The plan for an archetype pair is computed 
+		/// once, so moving an entity does not need to look up its columns.
+		struct MigrationPlan {
+			std::vector<std::pair<VectorBase*, VectorBase*>> m_move; //pairs of columns in this and the other archetype
+			std::vector<VectorBase*> m_construct; //columns of this archetype that get a default value
+			std::vector<VectorBase*> m_drop; //columns of the other archetype that are erased
+			Vector<Handle>* m_handlesTo{ nullptr }; //handle column of this archetype
+			Vector<Handle>* m_handlesFrom{ nullptr }; //handle column of the other archetype
+		};
+
+		/// @brief An edge of the archetype graph, leading to the archetype an entity moves to when types or tags are added or removed.
+		/// Edges are cached in the archetype the entity leaves, together with the migration plan of the target archetype.
+		struct Edge {
+			ArchetypeT* 	m_target{ nullptr };	//archetype the entity moves to, nullptr if the edge is not cached yet
+			MigrationPlan* 	m_plan{ nullptr };		//plan of the target archetype for moving entities from this one
+		};
+
+		/// @brief An edge for adding and removing several types and tags at once.
+		struct PackEdge {
+			Signature_t 	m_add;		//IDs of the added types and tags
+			Signature_t 	m_remove;	//IDs of the removed types and tags
+			Edge 			m_edge;		//the edge
+		};
+
+		/// @brief Find a cached edge for adding or removing a single type or tag. The edges are indexed by the type ID.
+		/// @param id ID of the type or tag.
+		/// @param add true if the type is added, false if it is removed.
+		/// @return Pointer to the edge, or nullptr if there is no such edge yet.
+		auto FindEdge(size_t id, bool add) -> Edge* {
+			auto& edges = add ? m_addEdges : m_removeEdges;
+			return id < edges.size() && edges[id].m_target ? &edges[id] : nullptr;
+		}
+
+		/// @brief Find a cached edge for several types and tags by comparing the signatures.
+		/// @param add IDs of the added types and tags.
+		/// @param remove IDs of the removed types and tags.
+		/// @return Pointer to the edge, or nullptr if there is no such edge yet.
+		auto FindEdge(const Signature_t& add, const Signature_t& remove) -> Edge* {
+			for (auto& edge : m_packEdges) { if (edge.m_add == add && edge.m_remove == remove) { return &edge.m_edge; } }
+			return nullptr;
+		}
+
+		/// @brief Cache an edge to another archetype for adding or removing a single type or tag.
+		/// @param id ID of the type or tag.
+		/// @param add true if the type is added, false if it is removed.
+		/// @param target The archetype entities move to.
+		/// @return Reference to the new edge.
+		auto AddEdge(size_t id, bool add, ArchetypeT* target) -> Edge& {
+			auto& edges = add ? m_addEdges : m_removeEdges;
+			if (id >= edges.size()) { edges.resize(id + 1); }
+			return edges[id] = Edge{ target, &target->GetMigrationPlan(*this) };
+		}
+
+		/// @brief Cache an edge to another archetype for several types and tags.
+		/// @param add IDs of the added types and tags.
+		/// @param remove IDs of the removed types and tags.
+		/// @param target The archetype entities move to.
+		/// @return Reference to the new edge.
+		auto AddEdge(const Signature_t& add, const Signature_t& remove, ArchetypeT* target) -> Edge& {
+			m_packEdges.push_back(PackEdge{ add, remove, Edge{ target, &target->GetMigrationPlan(*this) } });
+			return m_packEdges.back().m_edge;
+		}
+
 		/// @brief Move components from another archetype to this one. In the other archetype,
 		/// the last entity is moved to the erased one. This might result in a reindexing of the moved entity in the slot map.
+		/// Components are relocated, unless erasing from the other archetype is delayed because it is being iterated over.
+		/// The columns involved are taken from the migration plan for the other archetype.
 		/// @param other The other archetype.
 		/// @param other_index The index of the entity in the other archetype.
 		/// @return A pair of the index of the new entity in this archetype and the handle of the moved entity.
-		auto Move(Archetype& other, size_t other_index) -> std::pair<size_t, Handle> {
-			for (auto& ti : m_types) { //go through all maps
-				if (m_maps.contains(ti)) {
-					if (other.m_maps.contains(ti)) {
-						m_maps[ti]->copy(other.Map(ti), other_index); //insert the new value
-					}
-					else {
-						m_maps[ti]->push_back(); //insert an empty value
-					}
-				}
-			}
+		auto Move(ArchetypeT& other, size_t other_index) -> std::pair<size_t, Handle> {
+			return Move(other, other_index, GetMigrationPlan(other));
+		}
+
+		/// @brief Move components from another archetype to this one, using a migration plan of this archetype.
+		/// @param other The other archetype.
+		/// @param other_index The index of the entity in the other archetype.
+		/// @param plan The plan for moving entities from the other archetype, e.g. taken from an edge.
+		/// @return A pair of the index of the new entity in this archetype and the handle of the moved entity.
+		auto Move(ArchetypeT& other, size_t other_index, MigrationPlan& plan) -> std::pair<size_t, Handle> {
 			++m_changeCounter;
-			return { m_maps[Type<Handle>()]->size() - 1, other.Erase2(other_index) };
+			if (!other.IsDelayed(other_index)) {
+				size_t last{ other_index };
+				for (auto& [to, from] : plan.m_move) { last = to->relocate(from, other_index); } //move the value and erase it in the other map
+				for (auto to : plan.m_construct) { to->push_back(); } //insert an empty value
+				for (auto from : plan.m_drop) { from->erase(other_index); } //erase the components that are not moved
+				++other.m_changeCounter;
+				size_t index = plan.m_handlesTo->size() - 1;
+				ChunksChanged(index, index + 1, index);
+				other.ChunksChanged(other_index, other_index + 1, last + 1);
+				return { index, other_index < last ? (*plan.m_handlesFrom)[other_index] : Handle{} };
+			}
+
+			for (auto& [to, from] : plan.m_move) { to->copy(from, other_index); } //insert the new value
+			for (auto to : plan.m_construct) { to->push_back(); } //insert an empty value
+			size_t index = plan.m_handlesTo->size() - 1;
+			ChunksChanged(index, index + 1, index);
+			return { index, other.Erase2(other_index) };
 		}
 
 		/// @brief Clone the archetype.
 		/// @param other The archetype to clone.
 		/// @param ignore Ignore these types.
-		void Clone(Archetype& other, auto&& ignore) {
-			for (auto& ti : other.m_types) { //go through all maps
-				if (std::find(ignore.begin(), ignore.end(), ti) != ignore.end()) { continue; }
-				m_types.insert(ti); //add the type to the list, could be a tag
-				if (other.m_maps.contains(ti)) {
-					m_maps[ti] = other.Map(ti)->clone(); //make a component map like this one
-				}
+		void Clone(ArchetypeT& other, auto&& ignore) {
+			auto ignored = [&](size_t ti) { return std::find(ignore.begin(), ignore.end(), ti) != ignore.end(); };
+			for (auto& ti : other.m_types) { //go through all types
+				if (!ignored(ti)) { InsertType(ti, TypeIds::Get(ti)); } //add the type to the list, could be a tag
+			}
+			for (auto& map : other.m_maps) { //go through all maps
+				if (!ignored(map->GetType())) { AddColumn(map->clone()); } //make a component map like this one
 			}
 		}
 
 		/// @brief Get the number of entites in this archetype.
 		/// @return The number of entities.
 		size_t Size() {
-			return m_maps[Type<Handle>()]->size() - m_gaps.size();
+			return m_maps[0]->size() - m_gaps.size();
 		}
 
 		/// @brief Get the number of rows in this archetype.
 		/// This is the number of entities plus the number of gaps.
 		/// @return The number of rows.
 		size_t Number() {
-			return m_maps[Type<Handle>()]->size();
+			return m_maps[0]->size();
 		}
 
 		/// @brief Clear the archetype.
 		void Clear() {
+			size_t number = Number();
 			for (auto& map : m_maps) {
-				map.second->clear();
+				map->clear();
 			}
+			ChunksChanged(0, 0, number);
 			++m_changeCounter;
 		}
 
+		/// @brief Store the components of this archetype in chunks, each holding all columns for a number of rows.
+		/// Must be called after all components have been added, and before entities are inserted.
+		/// Nothing is changed if a component type is aligned to more than a cache line.
+		/// @param chunkBytes Target size of a chunk in bytes.
+		void UseChunks(size_t chunkBytes = CHUNK_BYTES) {
+			assert(!m_chunks && Number() == 0);
+			std::vector<VectorBase*> columns;
+			std::vector<size_t> sizes;
+			for (auto& map : m_maps) {
+				if (map->ElemAlign() > SEGMENT_ALIGNMENT) { return; }
+				columns.push_back(map.get());
+				sizes.push_back(map->ElemSize());
+			}
+			m_chunks = std::make_unique<ChunkStore>(sizes, chunkBytes, m_pool);
+			for (size_t i = 0; i < columns.size(); ++i) { columns[i]->attach(m_chunks.get(), i); }
+		}
+
+		/// @brief Get the chunk store of the archetype.
+		/// @return Pointer to the chunk store, or nullptr if the components are stored in separate vectors.
+		auto GetChunkStore() -> ChunkStore* {
+			return m_chunks.get();
+		}
+
 		/// @brief Print the archetype.
 		void Print() {
 			std::cout << "Archetype: " << Hash(m_types) << std::endl;
@@ -156,7 +351,7 @@ namespace vecs {
 			std::cout << std::endl;
 			for (auto& map : m_maps) {
 				std::cout << "Map: ";
-				map.second->print();
+				map->print();
 				std::cout << std::endl;
 			}
 			std::cout << "Entities: ";
@@ -172,7 +367,7 @@ namespace vecs {
 		/// @brief Validate the archetype. Make sure all maps have the same size.
 		void Validate() {
 			for (auto& map : m_maps) {
-				assert(map.second->size() == m_maps[Type<Handle>()]->size());
+				assert(map->size() == m_maps[0]->size());
 			}
 		}
 
@@ -188,9 +383,11 @@ namespace vecs {
 			return m_mutex;
 		}
 
+		/// @brief Add a tag to the archetype.
+		/// @param ti The tag.
 		void AddType(size_t ti) {
-			assert(!m_types.contains(ti));
-			m_types.insert(ti);	//add the type to the list
+			assert(!Has(ti));
+			InsertType(ti, TagId(ti));	//add the type to the list
 		};
 
 		/// @brief Add a new component to the archetype.
@@ -199,22 +396,25 @@ namespace vecs {
 		void AddComponent() {
 			using T = std::decay_t<U>; //remove pointer or reference
 			size_t ti = Type<T>();
-			assert(!m_types.contains(ti));
-			m_types.insert(ti);	//add the type to the list
-			m_maps[ti] = std::make_unique<Vector<T>>(); //create the component map
+			assert(!Has(ti) && !m_chunks);
+			InsertType(ti, TypeId<T>());	//add the type to the list
+			if constexpr (SegmentTraits<T>::memory != SegmentMemory::Heap && MAPPED_MEMORY) { //one large mapped segment
+				AddColumn(std::make_unique<Vector<T>>(SegmentBits<T>(SegmentTraits<T>::mappedBytes), m_pool, 0, SegmentTraits<T>::memory));
+			} else {
+				AddColumn(std::make_unique<Vector<T>>(SegmentBits<T>(SegmentTraits<T>::bytes), m_pool, SegmentBits<T>(SegmentTraits<T>::firstBytes))); //create the component map
+			}
 		};
 
-		/// @brief Add a new component value to the archetype.
+		/// @brief Add a new component value to the archetype. The value is constructed in place in the component map.
 		/// @param v The component value.
 		/// @return The index of the component value.
 		template<typename U>
 		auto AddValue(U&& v) -> size_t {
-			using T = std::decay_t<U>;
-			return m_maps[Type<T>()]->push_back(std::forward<U>(v));	//insert the component value
+			return Map<U>()->emplace_back(std::forward<U>(v));	//insert the component value
 		};
 
 		auto AddEmptyValue(size_t ti) -> size_t {
-			return m_maps[ti]->push_back();	//insert the component value
+			return Map(ti)->push_back();	//insert the component value
 		};
 
 		/// @brief Get the map of the components.
@@ -223,18 +423,25 @@ namespace vecs {
 		template<typename U>
 		auto Map() -> Vector<std::decay_t<U>>* {
 			using T = std::decay_t<U>;
-			auto it = m_maps.find(Type<T>());
-			assert(it != m_maps.end());
-			return static_cast<Vector<T>*>(it->second.get());
+			size_t id = TypeId<T>();
+			assert(id < m_columnIndex.size() && m_columnIndex[id] != NO_COLUMN);
+			return static_cast<Vector<T>*>(m_maps[m_columnIndex[id]].get());
 		}
 
-		/// @brief Get the data of the components.
+		/// @brief Get the data of the components. The columns are searched for the type hash.
 		/// @param ti Type index of the component.
 		/// @return Pointer to the component map base class.
 		auto Map(size_t ti) -> VectorBase* {
-			auto it = m_maps.find(ti);
+			auto it = std::ranges::find_if(m_maps, [&](auto& map) { return map->GetType() == ti; });
 			assert(it != m_maps.end());
-			return it->second.get();
+			return it->get();
+		}
+
+		/// @brief Get the column of a component type.
+		/// @param id Dense type ID of the component.
+		/// @return Pointer to the component map, or nullptr if the archetype has no such component.
+		auto Column(size_t id) -> VectorBase* {
+			return id < m_columnIndex.size() && m_columnIndex[id] != NO_COLUMN ? m_maps[m_columnIndex[id]].get() : nullptr;
 		}
 
 	private:
@@ -246,20 +453,87 @@ namespace vecs {
 		auto Erase2(size_t index) -> Handle {
 			size_t last{ index };
 			++m_changeCounter;
-			if (m_iteratingArchetype == this && index <= m_iteratingIndex) {  //delayed erasure
+			if (IsDelayed(index)) {  //delayed erasure
 				m_gaps.push_back(index);
 				(*Map<Handle>())[index] = Handle{}; //invalidate the handle
+				if (m_chunks) { ChunksChanged(index, index + 1, Number()); }
 				return Handle{};
 			}
-			for (auto& it : m_maps) { last = it.second->erase(index); } //Erase from the component map
+			for (auto& map : m_maps) { last = map->erase(index); } //Erase from the component map
+			ChunksChanged(index, index + 1, last + 1);
 			return index < last ? (*Map<Handle>())[index] : Handle{}; //return the handle of the moved entity
 		}
 
-		using Map_t = std::unordered_map<size_t, std::unique_ptr<VectorBase>>;
+		/// @brief Add a type to the sorted list of types and to the signature, if it is not there yet.
+		/// @param ti Type hash or tag.
+		/// @param id Dense ID of the type or tag.
+		void InsertType(size_t ti, size_t id) {
+			auto it = std::ranges::lower_bound(m_types, ti);
+			if (it != m_types.end() && *it == ti) { return; }
+			m_types.insert(it, ti);
+			m_signature.set(id);
+		}
+
+		/// @brief Add a column for a component map, or replace the column holding the same type.
+		/// @param map The component map.
+		void AddColumn(std::unique_ptr<VectorBase> map) {
+			size_t id = map->GetTypeId();
+			if (id >= m_columnIndex.size()) { m_columnIndex.resize(id + 1, NO_COLUMN); }
+			if (m_columnIndex[id] != NO_COLUMN) { m_maps[m_columnIndex[id]] = std::move(map); return; }
+			m_columnIndex[id] = (uint32_t)m_maps.size();
+			m_maps.push_back(std::move(map));
+		}
+
+		/// @brief Update the chunk headers after rows have been changed, if the archetype uses chunks.
+		/// @param first Index of the first changed row.
+		/// @param last Index one past the last changed row.
+		/// @param oldRows Number of rows before the change.
+		void ChunksChanged(size_t first, size_t last, size_t oldRows) {
+			if (m_chunks) { m_chunks->Changed(first, last, oldRows, Number()); }
+		}
+
+		/// @brief Get the migration plan for moving entities from another archetype to this one, create it if necessary.
+		/// @param other The other archetype.
+		/// @return Reference to the plan.
+		auto GetMigrationPlan(ArchetypeT& other) -> MigrationPlan& {
+			auto it = m_plans.find(&other);
+			if (it != m_plans.end()) { return it->second; }
+			MigrationPlan& plan = m_plans[&other];
+			for (auto& map : m_maps) {
+				auto from = other.Column(map->GetTypeId());
+				if (from) { plan.m_move.emplace_back(map.get(), from); }
+				else { plan.m_construct.push_back(map.get()); }
+			}
+			for (auto& map : other.m_maps) {
+				if (!Column(map->GetTypeId())) { plan.m_drop.push_back(map.get()); }
+			}
+			plan.m_handlesTo = Map<Handle>();
+			plan.m_handlesFrom = other.Map<Handle>();
+			return plan;
+		}
+
+		/// @brief Test whether erasing an entity must be delayed, because this archetype is iterated over and the entity is not behind the iterator.
+		/// @param index The index of the entity in the archetype.
+		/// @return True if erasure is delayed.
+		bool IsDelayed(size_t index) {
+			return m_iteratingArchetype == this && index <= m_iteratingIndex;
+		}
+
+		static constexpr uint32_t NO_COLUMN = std::numeric_limits<uint32_t>::max(); ///< Marks types without a column.
+
+		using Map_t = std::vector<std::unique_ptr<VectorBase>>;
 		Mutex_t 			m_mutex; //mutex for thread safety
+		SegmentPool* 		m_pool{ nullptr }; //pool of the registry for recycling segments
+		std::unique_ptr<ChunkStore> m_chunks; //chunks holding all columns, nullptr if columns are separate vectors, must outlive m_maps
 		Size_t 				m_changeCounter{ 0 }; //changes invalidate references
-		std::set<size_t> 	m_types; //types of components
-		Map_t 				m_maps; //map from type index to component data
+		std::vector<size_t> m_types; //types of components and tags, sorted
+		Signature_t 		m_signature; //IDs of types of components and tags
+		Map_t 				m_maps; //columns of component data, the handle is in column 0
+		std::vector<uint32_t> m_columnIndex; //map from type ID to column, or NO_COLUMN
+		std::unordered_map<ArchetypeT*, MigrationPlan> m_plans; //migration plans from other archetypes to this one
+		std::vector<Edge> 	m_addEdges; //edges for adding a single type or tag, indexed by its ID
+		std::vector<Edge> 	m_removeEdges; //edges for removing a single type or tag, indexed by its ID
+		std::vector<PackEdge> m_packEdges; //edges for adding or removing several types and tags
 
 	public:
 		//Parallelization strategy (not yet implemented):
@@ -270,7 +544,7 @@ namespace vecs {
 		//  - If E is BEFORE or EQUAL the current entity C, filling the gap is DELAYED. Instead, the index if E
 		//	  is stored in a list of delayed entities. When the iteration is finished, the gaps are closed.
 		//    Also the archetype stays in write lock until the end of the iteration.
-		inline static thread_local Archetype* m_iteratingArchetype{ nullptr }; //for iterating over archetypes
+		inline static thread_local ArchetypeT* m_iteratingArchetype{ nullptr }; //for iterating over archetypes
 		inline static thread_local size_t m_iteratingIndex{ std::numeric_limits<size_t>::max() }; //current iterator index
 		inline static thread_local std::vector<size_t> m_gaps{}; //gaps from previous erasures that must be filled
 
@@ -288,7 +562,7 @@ namespace vecs {
 
 			for (auto& map : m_maps) {
 				if (count++)json += ",";
-				std::string sub = map.second->ToJSON(aindex);
+				std::string sub = map->ToJSON(aindex);
 				json += sub;
 			}
 			return json + "]";
@@ -306,7 +580,7 @@ namespace vecs {
 		size_t GetEstSize() {
 			size_t elemSize = 0;
 			for (auto& map : m_maps) {
-				elemSize += map.second->ElemSize();
+				elemSize += map->ElemSize();
 			}
 			return elemSize * Size();
 		}
@@ -326,7 +600,7 @@ namespace vecs {
 			count = 0;
 			for (auto& map : m_maps) {
 				if (count++) json += ",";
-				json += map.second->ToJSON();
+				json += map->ToJSON();
 			}
 			json += "],";
 			json += "\"entities\":[";
@@ -351,6 +625,100 @@ namespace vecs {
 
 	}; //end of Archetype
 
+	using Archetype = ArchetypeT<Handle>; ///< Archetype with the default handle type.
+
+
+	//----------------------------------------------------------------------------------------------
+	//Archetype directory
+
+	/// @brief The archetypes of a registry, found by their signature. The archetypes are owned by a vector, which is also 
+	/// used for iterating over them, and archetype pointers stay valid. An open addressing table with linear probing maps 
+	/// signatures to positions in this vector. Each slot stores the hash and the full signature, so archetypes whose
+	/// hashes collide are still told apart. For each type ID the directory also lists the archetypes having this
+	/// component type or tag, so queries can start from the shortest list. Archetypes are never removed.
+	/// @tparam A The archetype type.
+	template<typename A>
+	class ArchetypeDirectory {
+
+		static constexpr uint32_t EMPTY = std::numeric_limits<uint32_t>::max(); ///< Marks an empty slot.
+
+		/// @brief A slot of the probing table.
+		struct Slot {
+			size_t 		m_hash{0};			//hash of the signature
+			uint32_t 	m_index{EMPTY};		//index of the archetype in m_archetypes, or EMPTY
+			Signature_t m_signature;		//signature of the archetype
+		};
+
+	public:
+		ArchetypeDirectory() : m_slots(64), m_mask{63} {}
+
+		/// @brief Find an archetype.
+		/// @param signature The IDs of the component types and tags of the archetype.
+		/// @return Pointer to the archetype, or nullptr if there is no archetype with this signature.
+		auto Find(const Signature_t& signature) -> A* {
+			size_t hash = HashOf(signature);
+			for (size_t slot = hash & m_mask; m_slots[slot].m_index != EMPTY; slot = (slot + 1) & m_mask) {
+				if (m_slots[slot].m_hash == hash && m_slots[slot].m_signature == signature) { return m_archetypes[m_slots[slot].m_index].get(); }
+			}
+			return nullptr;
+		}
+
+		/// @brief Add an archetype. There must not be an archetype with the same signature yet.
+		/// @param arch The archetype.
+		/// @return Pointer to the archetype.
+		auto Insert(std::unique_ptr<A> arch) -> A* {
+			assert(!Find(arch->Signature()));
+			if (2 * (m_archetypes.size() + 1) > m_slots.size()) { Grow(); }
+			auto& signature = arch->Signature();
+			Place(signature, (uint32_t)m_archetypes.size());
+			for (size_t id = 0; id < TypeIdCount(); ++id) {
+				if (!signature.test(id)) { continue; }
+				if (id >= m_withType.size()) { m_withType.resize(id + 1); }
+				m_withType[id].push_back(arch.get());
+			}
+			m_archetypes.push_back(std::move(arch));
+			return m_archetypes.back().get();
+		}
+
+		/// @brief Number of archetypes.
+		auto Size() const -> size_t { return m_archetypes.size(); }
+
+		/// @brief Get the archetypes having a component type or tag.
+		/// @param id The ID of the type or tag.
+		/// @return The archetypes, in the order they were created.
+		auto WithType(size_t id) const -> const std::vector<A*>& {
+			static const std::vector<A*> none;
+			return id < m_withType.size() ? m_withType[id] : none;
+		}
+
+		auto begin() { return m_archetypes.begin(); }
+		auto end() { return m_archetypes.end(); }
+
+		/// @brief Hash of a signature.
+		static auto HashOf(const Signature_t& signature) -> size_t { return std::hash<Signature_t>{}(signature); }
+
+	private:
+		/// @brief Put an archetype index into the first free slot of the probe sequence of its signature.
+		void Place(const Signature_t& signature, uint32_t index) {
+			size_t hash = HashOf(signature);
+			size_t slot = hash & m_mask;
+			while (m_slots[slot].m_index != EMPTY) { slot = (slot + 1) & m_mask; }
+			m_slots[slot] = Slot{ hash, index, signature };
+		}
+
+		/// @brief Double the number of slots and place all archetypes again.
+		void Grow() {
+			m_slots.assign(2 * m_slots.size(), Slot{});
+			m_mask = m_slots.size() - 1;
+			for (uint32_t i = 0; i < m_archetypes.size(); ++i) { Place(m_archetypes[i]->Signature(), i); }
+		}
+
+		std::vector<Slot> m_slots;						///< Probing table, a power of 2 of slots.
+		size_t 			  m_mask;						///< Number of slots - 1.
+		std::vector<std::unique_ptr<A>> m_archetypes;	///< The archetypes, in the order they were created.
+		std::vector<std::vector<A*>> 	m_withType;		///< For each type ID the archetypes having this type or tag.
+	};
+
 } //namespace vecs2
 
 
@@ -74,7 +74,7 @@ namespace vecs {
 
         private:
             Registry* registry{ nullptr };
-            std::map<Handle, std::string> watched;
+            HandleMap<std::string> watched;
             bool active{ false };
             size_t handles{ 0 };
             float avgComp{ 0.f };
@@ -99,11 +99,11 @@ namespace vecs {
             /// @brief set entities to watch for changes.
             /// @param newSet - new set of VECS Handles to watch.
             /// @return Currently always true.
-            bool Watch(std::set<Handle>& newSet) {
-                std::set<Handle> toRemove;
+            bool Watch(HandleSet<>& newSet) {
+                std::vector<Handle> toRemove;
                 for (auto& el : watched)
                     if (!newSet.contains(el.first))
-                        toRemove.insert(el.first);
+                        toRemove.push_back(el.first);
                 for (auto& el : newSet)
                     if (!watched.contains(el))
                         watched[el] = "";
@@ -454,7 +454,7 @@ namespace vecs {
                 // "watch":id or [id,id,...]  - adds a (set of) id(s) to the watched set
                 if (msgjson.contains("watchlist")) {
                     auto& watch = msgjson["watchlist"];
-                    std::set<Handle> newWatchlist;
+                    HandleSet<> newWatchlist;
                     if (watch.is_array()) {
                         for (auto& el : watch) {
                             if (el.is_number_unsigned()) {
@@ -5,37 +5,46 @@ namespace vecs {
 	//----------------------------------------------------------------------------------------------
 	//Handles
 
-	/// @brief A handle for an entity or a component.
+	/// @brief A handle for an entity or a component. The index, version and storage index are packed into 
+	/// one integer with constexpr shifts and masks. If all fields fit into 32 bits, the handle takes 4 bytes, else 8 bytes.
+	/// @tparam INDEX_BITS Number of bits of the slot map index.
+	/// @tparam VERSION_BITS Number of bits of the version counter.
+	/// @tparam STORAGE_BITS Number of bits of the storage index, i.e., the slot map shard.
 	template<size_t INDEX_BITS=32, size_t VERSION_BITS=24, size_t STORAGE_BITS=8>
 	struct HandleT {
-		using type_t = typename vsty::strong_type_t<size_t, vsty::counter<>, 
-							std::integral_constant<size_t, std::numeric_limits<size_t>::max()>>; ///< Strong type for the handle type.
+		static_assert(INDEX_BITS > 0 && VERSION_BITS > 0 && INDEX_BITS + VERSION_BITS + STORAGE_BITS <= 64, "A handle must fit into 64 bits!");
 
 	public:
-		HandleT() = default; ///< Default constructor.
-
-		HandleT(size_t index, size_t version, size_t storageIndex=0) : 
-			m_value{std::numeric_limits<size_t>::max()} { 
-			m_value.set_bits(index, 0, INDEX_BITS);
-			m_value.set_bits(version, INDEX_BITS, VERSION_BITS);
-			m_value.set_bits(storageIndex, INDEX_BITS + VERSION_BITS, STORAGE_BITS);
-		};
-
-		HandleT(size_t v) : m_value{type_t{v}} {};
-
-		size_t GetIndex() const { return m_value.get_bits(0, INDEX_BITS); }
-		size_t GetVersion() const { return m_value.get_bits(INDEX_BITS, VERSION_BITS); }
-		size_t GetStorageIndex() const { return m_value.get_bits(INDEX_BITS + VERSION_BITS); }
-		size_t GetVersionedIndex() const { return (GetVersion() << VERSION_BITS) + GetIndex(); }
-		size_t GetValue() const { return m_value();  };
-		bool IsValid() const { return m_value != std::numeric_limits<size_t>::max(); }
-		HandleT& operator=(const HandleT& other) { m_value = other.m_value; return *this; }
-		bool operator==(const HandleT& other) const { return GetIndex() == other.GetIndex() && GetVersion() == other.GetVersion(); }
-		bool operator!=(const HandleT& other) const { return !(*this == other); }
-		bool operator<(const HandleT& other) const { return GetIndex() < other.GetIndex(); }
+		using value_t = std::conditional_t<(INDEX_BITS + VERSION_BITS + STORAGE_BITS <= 32), uint32_t, uint64_t>; ///< Type of the packed value.
+
+		static constexpr size_t INDEX = INDEX_BITS; ///< Number of index bits.
+		static constexpr size_t VERSION = VERSION_BITS; ///< Number of version bits.
+		static constexpr size_t STORAGE = STORAGE_BITS; ///< Number of storage index bits.
+		static constexpr value_t INDEX_MASK = (value_t)((uint64_t{1} << INDEX_BITS) - 1); ///< Mask of the index after shifting.
+		static constexpr value_t VERSION_MASK = (value_t)((uint64_t{1} << VERSION_BITS) - 1); ///< Mask of the version after shifting.
+		static constexpr value_t STORAGE_MASK = (value_t)((uint64_t{1} << STORAGE_BITS) - 1); ///< Mask of the storage index after shifting.
+
+		constexpr HandleT() = default; ///< Default constructor, creates an invalid handle.
+
+		constexpr HandleT(size_t index, size_t version, size_t storageIndex=0) : 
+			m_value{ (value_t)( (index & INDEX_MASK) 
+				| ((version & VERSION_MASK) << INDEX_BITS) 
+				| ((storageIndex & STORAGE_MASK) << (INDEX_BITS + VERSION_BITS)) ) } {};
+
+		constexpr HandleT(size_t v) : m_value{(value_t)v} {};
+
+		constexpr size_t GetIndex() const { return m_value & INDEX_MASK; }
+		constexpr size_t GetVersion() const { return (m_value >> INDEX_BITS) & VERSION_MASK; }
+		constexpr size_t GetStorageIndex() const { return (m_value >> (INDEX_BITS + VERSION_BITS)) & STORAGE_MASK; }
+		constexpr size_t GetVersionedIndex() const { return (GetVersion() << VERSION_BITS) + GetIndex(); }
+		constexpr size_t GetValue() const { return m_value;  };
+		constexpr bool IsValid() const { return m_value != std::numeric_limits<value_t>::max(); }
+		constexpr bool operator==(const HandleT& other) const { return GetIndex() == other.GetIndex() && GetVersion() == other.GetVersion(); }
+		constexpr bool operator!=(const HandleT& other) const { return !(*this == other); }
+		constexpr bool operator<(const HandleT& other) const { return GetIndex() < other.GetIndex(); }
 
 	private:
-		type_t m_value; ///< Strong type for the handle.
+		value_t m_value{std::numeric_limits<value_t>::max()}; ///< Packed index, version and storage index.
 
 	//Method for Console communication
 	public:
@@ -52,12 +61,22 @@ namespace vecs {
 
 	using Handle = HandleT<32,24,8>; ///< Type of the handle.
 
-	inline bool IsValid(const Handle& handle) {
+	template<size_t I, size_t V, size_t S>
+	inline bool IsValid(const HandleT<I, V, S>& handle) {
 		return handle.IsValid();
 	}
 	
 }
 
-inline std::ostream& operator<<(std::ostream& os, const vecs::Handle& handle) {
+template<size_t I, size_t V, size_t S>
+inline std::ostream& operator<<(std::ostream& os, const vecs::HandleT<I, V, S>& handle) {
 	return os << "{" <<  handle.GetIndex() << ", " << handle.GetVersion() << ", " << handle.GetStorageIndex() << "}"; 
 }
+
+/// @brief Hash of a handle, for std::unordered_set and std::unordered_map. Like operator==, it uses index and version only.
+template<size_t I, size_t V, size_t S>
+struct std::hash<vecs::HandleT<I, V, S>> {
+	auto operator()(const vecs::HandleT<I, V, S>& handle) const noexcept -> size_t {
+		return std::hash<uint64_t>{}( handle.GetIndex() | ((uint64_t)handle.GetVersion() << I) );
+	}
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+namespace vecs {
+
+	//----------------------------------------------------------------------------------------------
+	//Handle sets and maps
+
+	/// @brief Open addressing hash table with handle keys, the common part of HandleSet and HandleMap.
+	/// Entries are stored densely in a vector, so iterating and clearing only touch the entries themselves.
+	/// A table with linear probing maps handles to positions in the dense vector. The index of a handle is used
+	/// as hash, since live entities have different indices. Erasing moves the last entry into the hole and
+	/// shifts the probe sequence back, so there are no tombstones.
+	/// @tparam H The handle type.
+	/// @tparam E The entry type, either the handle itself or a pair of handle and value.
+	template<typename H, typename E>
+	class HandleTable {
+
+	protected:
+		static constexpr uint32_t EMPTY = std::numeric_limits<uint32_t>::max(); ///< Marks an empty table slot.
+
+		/// @brief A slot of the probing table.
+		struct Slot {
+			H 		 m_handle;			//key of the entry
+			uint32_t m_pos{EMPTY};		//position of the entry in the dense vector, or EMPTY
+		};
+
+	public:
+		using Handle = H; ///< Type of the keys.
+
+		/// @brief Constructor, creates an empty table.
+		/// @param capacity Number of entries that can be inserted without growing the table.
+		HandleTable(size_t capacity = 16) { reserve(capacity); }
+
+		/// @brief Test whether a handle is contained.
+		/// @param handle The handle.
+		/// @return true if the handle is contained, else false.
+		auto contains(H handle) const -> bool { return m_slots[Find(handle)].m_pos != EMPTY; }
+
+		/// @brief Count the occurrences of a handle.
+		/// @param handle The handle.
+		/// @return 1 if the handle is contained, else 0.
+		auto count(H handle) const -> size_t { return contains(handle) ? 1 : 0; }
+
+		/// @brief Erase a handle. The last entry is moved into its place, so iteration order changes.
+		/// @param handle The handle.
+		/// @return Number of erased entries, 0 or 1.
+		auto erase(H handle) -> size_t {
+			size_t slot = Find(handle);
+			uint32_t pos = m_slots[slot].m_pos;
+			if( pos == EMPTY ) return 0;
+			Remove(slot);
+			if( pos + 1 < m_entries.size() ) {
+				m_entries[pos] = std::move(m_entries.back());
+				m_slots[Find(Key(m_entries[pos]))].m_pos = pos;
+			}
+			m_entries.pop_back();
+			return 1;
+		}
+
+		auto size() const -> size_t { return m_entries.size(); }
+		auto empty() const -> bool { return m_entries.empty(); }
+
+		/// @brief Remove all entries. Only the table slots of the entries are reset, so clearing costs
+		/// O(size) rather than O(capacity). Each entry is found by walking from its home slot to its position.
+		void clear() {
+			for( uint32_t pos = 0; pos < m_entries.size(); ++pos ) {
+				size_t slot = Home(Key(m_entries[pos]));
+				while( m_slots[slot].m_pos != pos ) { slot = (slot + 1) & m_mask; }
+				m_slots[slot].m_pos = EMPTY;
+			}
+			m_entries.clear();
+		}
+
+		/// @brief Make room for a number of entries. The table is kept at most half full.
+		/// @param capacity Number of entries that can be inserted without growing the table.
+		void reserve(size_t capacity) {
+			size_t number = std::bit_ceil(std::max<size_t>(2 * capacity, 16));
+			if( number <= m_slots.size() ) return;
+			m_slots.assign(number, Slot{});
+			m_mask = number - 1;
+			for( uint32_t pos = 0; pos < m_entries.size(); ++pos ) {
+				H handle = Key(m_entries[pos]);
+				m_slots[Find(handle)] = Slot{handle, pos};
+			}
+			m_entries.reserve(capacity);
+		}
+
+	protected:
+		static auto Key(const H& entry) -> H { return entry; }
+		template<typename V> static auto Key(const std::pair<H, V>& entry) -> H { return entry.first; }
+
+		/// @brief Home slot of a handle, given by the lowest bits of its index.
+		auto Home(H handle) const -> size_t { return handle.GetIndex() & m_mask; }
+
+		/// @brief Find the slot of a handle, or the empty slot where it would be inserted.
+		auto Find(H handle) const -> size_t {
+			size_t slot = Home(handle);
+			while( m_slots[slot].m_pos != EMPTY && m_slots[slot].m_handle != handle ) { slot = (slot + 1) & m_mask; }
+			return slot;
+		}
+
+		/// @brief Insert a new entry if the handle is not contained yet.
+		/// @param handle The handle.
+		/// @param args Arguments for constructing the entry.
+		/// @return Position of the entry in the dense vector, and whether it was inserted.
+		template<typename... Args>
+		auto Emplace(H handle, Args&&... args) -> std::pair<uint32_t, bool> {
+			if( 2 * (m_entries.size() + 1) > m_slots.size() ) reserve(2 * m_entries.size() + 1);
+			size_t slot = Find(handle);
+			if( m_slots[slot].m_pos != EMPTY ) return { m_slots[slot].m_pos, false };
+			uint32_t pos = (uint32_t)m_entries.size();
+			m_slots[slot] = Slot{handle, pos};
+			m_entries.emplace_back(std::forward<Args>(args)...);
+			return { pos, true };
+		}
+
+		/// @brief Empty a table slot with backward shift deletion. Following entries of the probe sequence
+		/// are moved into the hole if this brings them closer to their home slot.
+		/// @param hole The slot to empty.
+		void Remove(size_t hole) {
+			size_t next = (hole + 1) & m_mask;
+			while( m_slots[next].m_pos != EMPTY ) {
+				size_t home = Home(m_slots[next].m_handle);
+				if( ((next - home) & m_mask) >= ((next - hole) & m_mask) ) {
+					m_slots[hole] = m_slots[next];
+					hole = next;
+				}
+				next = (next + 1) & m_mask;
+			}
+			m_slots[hole].m_pos = EMPTY;
+		}
+
+		std::vector<Slot> m_slots;		///< Probing table, a power of 2 of slots.
+		std::vector<E>	  m_entries;	///< Dense entries for iteration.
+		size_t 			  m_mask{0};	///< Number of slots - 1.
+	};
+
+
+	/// @brief A set of handles, replacing std::set<Handle> without allocating a node per entity.
+	/// @tparam H The handle type.
+	template<typename H = Handle>
+	class HandleSet : public HandleTable<H, H> {
+
+	public:
+		using HandleTable<H, H>::HandleTable;
+
+		/// @brief Insert a handle.
+		/// @param handle The handle.
+		/// @return true if the handle was inserted, false if it was already contained.
+		auto insert(H handle) -> bool { return this->Emplace(handle, handle).second; }
+
+		auto begin() const { return this->m_entries.cbegin(); }
+		auto end() const { return this->m_entries.cend(); }
+	};
+
+
+	/// @brief A map from handles to values, replacing std::map<Handle, V> without allocating a node per entity.
+	/// Iteration yields std::pair<H, V>, do not change the handle of an entry.
+	/// @tparam V The value type.
+	/// @tparam H The handle type.
+	template<typename V, typename H = Handle>
+	class HandleMap : public HandleTable<H, std::pair<H, V>> {
+
+	public:
+		using HandleTable<H, std::pair<H, V>>::HandleTable;
+
+		/// @brief Get the value of a handle, inserting a default value if the handle is not contained.
+		/// @param handle The handle.
+		/// @return Reference to the value.
+		auto operator[](H handle) -> V& { return this->m_entries[this->Emplace(handle, handle, V{}).first].second; }
+
+		/// @brief Insert a value for a handle, if the handle is not contained yet.
+		/// @param handle The handle.
+		/// @param value The value.
+		/// @return true if the value was inserted, false if the handle was already contained.
+		auto insert(H handle, V value) -> bool { return this->Emplace(handle, handle, std::move(value)).second; }
+
+		/// @brief Find the entry of a handle.
+		/// @param handle The handle.
+		/// @return Iterator to the entry, or end() if the handle is not contained.
+		auto find(H handle) {
+			uint32_t pos = this->m_slots[this->Find(handle)].m_pos;
+			return pos == this->EMPTY ? end() : begin() + pos;
+		}
+
+		auto begin() { return this->m_entries.begin(); }
+		auto end() { return this->m_entries.end(); }
+		auto begin() const { return this->m_entries.cbegin(); }
+		auto end() const { return this->m_entries.cend(); }
+	};
+
+}
+
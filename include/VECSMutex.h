@@ -8,6 +8,12 @@ namespace vecs {
 	const int LOCKGUARDTYPE_SEQUENTIAL = 0;
 	const int LOCKGUARDTYPE_PARALLEL = 1;
 
+	#ifdef REGISTRYTYPE_SEQUENTIAL
+		const int LOCKGUARDTYPE_REGISTRY = LOCKGUARDTYPE_SEQUENTIAL; ///< Lock guard type for data shared by a whole registry.
+	#else
+		const int LOCKGUARDTYPE_REGISTRY = LOCKGUARDTYPE_PARALLEL;
+	#endif
+
 	/// @brief An exclusive lock guard for a mutex, meaning that only one thread can lock the mutex at a time.
 	/// A LockGuard is used to lock and unlock a mutex in a RAII manner.
 	/// In case of two simultaneous locks, the mutexes are locked in the correct order to avoid deadlocks.
@@ -22,31 +22,29 @@ namespace vecs {
 
 
 	/// @brief A registry for entities and components.
-	class Registry{
+	/// @tparam H The handle type. Use a compact handle like HandleT<20,10,2> if components store many handles,
+	/// or a wide handle if the registry must hold more than 2^32 entities.
+	template<typename H>
+	class RegistryT{
 
-		/// @brief Entry for the seach cache
-		struct TypeSetAndHash {
-			std::set<size_t> m_types;	//set of types that have been searched for
-			size_t m_hash;				//hash of the set
-		};
+	public:
+		using Handle = H; ///< Type of the handles.
+		using Archetype = ArchetypeT<H>; ///< Type of the archetypes.
 
-		template<vecs::VecsPOD T>
-		struct SlotMapAndMutex {
-			SlotMap<T> m_slotMap;
-			Mutex_t m_mutex;
-			SlotMapAndMutex( uint32_t storageIndex, uint32_t bits ) : m_slotMap{storageIndex, bits}, m_mutex{} {};
-			SlotMapAndMutex( const SlotMapAndMutex& other ) : m_slotMap{other.m_slotMap}, m_mutex{} {};
-		};
+	private:
 
 		#ifdef REGISTRYTYPE_SEQUENTIAL
 			using NUMBER_SLOTMAPS = std::integral_constant<int, 1>;
+			template<vecs::VecsPOD T> using SlotMap_t = SlotMap<T, H>;
 		#else
-			using NUMBER_SLOTMAPS = std::integral_constant<int, 16>;
+			using NUMBER_SLOTMAPS = std::integral_constant<int, std::min(16, 1 << H::STORAGE)>; //each shard needs its storage index
+			template<vecs::VecsPOD T> using SlotMap_t = ConcurrentSlotMap<T, H>; //lock free, no need to lock the mutex
 		#endif
 
-		using Slot_t = typename SlotMap<typename Archetype::ArchetypeAndIndex>::Slot;
-		using SlotMaps_t = std::vector<SlotMapAndMutex<typename Archetype::ArchetypeAndIndex>>;
-		using HashMap_t = std::map<size_t, std::unique_ptr<Archetype>>;
+		using Slot_t = typename SlotMap_t<typename Archetype::ArchetypeAndIndex>::Slot;
+		using Version_t = typename SlotMap_t<typename Archetype::ArchetypeAndIndex>::Version_t;
+		using SlotMaps_t = SlotMapShards<SlotMap_t<typename Archetype::ArchetypeAndIndex>>;
+		using Directory_t = ArchetypeDirectory<Archetype>;
 
 	public:	
 
@@ -60,11 +58,11 @@ namespace vecs {
 
 		public:
 			Ref() = default;
-			Ref(Handle handle, Slot_t& slot) : m_handle{handle}, m_slot{&slot}, m_archetype{slot.m_value.m_arch} {}
-			Ref(const Ref& other) : m_handle{other.m_handle}, m_slot{other.m_slot}, m_archetype{other.m_archetype} {}
+			Ref(Handle handle, Slot_t slot) : m_handle{handle}, m_version{&slot.m_version}, m_value{&slot.m_value}, m_archetype{slot.m_value.m_arch} {}
+			Ref(const Ref& other) : m_handle{other.m_handle}, m_version{other.m_version}, m_value{other.m_value}, m_archetype{other.m_archetype} {}
 
-			bool IsValid() { return m_slot != nullptr; }
-			bool Exists() { return m_slot->m_version == m_handle.GetVersion(); }
+			bool IsValid() { return m_version != nullptr; }
+			bool Exists() { return *m_version == m_handle.GetVersion(); }
 			auto operator()() -> T& {return GetReference(); }
 			auto operator=(T&& value) -> void { GetReference() = std::forward<T>(value); }
 			     operator T&() { return GetReference(); }
@@ -73,10 +71,10 @@ namespace vecs {
 
 		private:
 			auto GetReference() -> T& {
-				auto arch = m_slot->m_value.m_arch;
-				auto index = m_slot->m_value.m_index;
-				if( !m_slot || m_slot->m_version != m_handle.GetVersion() || ( arch != m_archetype && !arch->Has(Type<T>()) )  ) {
-					if( !arch->Has(Type<T>()) ) {
+				auto arch = m_value->m_arch;
+				auto index = m_value->m_index;
+				if( !m_version || *m_version != m_handle.GetVersion() || ( arch != m_archetype && !arch->template Has<T>() )  ) {
+					if( !arch->template Has<T>() ) {
 						std::cout << "Reference to type " << typeid(std::declval<T>()).name() << " invalidated because of adding or erasing a component or erasing an entity!" << std::endl;
 						assert(false);
 						exit(-1);
@@ -87,7 +85,8 @@ namespace vecs {
 			}
 
 			Handle m_handle{};
-			Slot_t* m_slot{nullptr};
+			Version_t* m_version{nullptr};
+			Archetype::ArchetypeAndIndex* m_value{nullptr};
 			Archetype *m_archetype{nullptr};
 		};
 
@@ -101,11 +100,11 @@ namespace vecs {
 
 		public:
 			Ref() = default;		
-			Ref(Handle handle, Slot_t& slot) : m_handle{handle}, m_slot{&slot}, m_archetype{slot.m_value.m_arch} {}
-			Ref(const Ref& other) : m_handle{other.m_handle}, m_slot{other.m_slot}, m_archetype{other.m_archetype} {}
+			Ref(Handle handle, Slot_t slot) : m_handle{handle}, m_version{&slot.m_version}, m_value{&slot.m_value}, m_archetype{slot.m_value.m_arch} {}
+			Ref(const Ref& other) : m_handle{other.m_handle}, m_version{other.m_version}, m_value{other.m_value}, m_archetype{other.m_archetype} {}
 
-			bool IsValid() { return m_slot != nullptr; }
-			bool Exists() { return m_slot->m_version == m_handle.GetVersion(); }
+			bool IsValid() { return m_version != nullptr; }
+			bool Exists() { return *m_version == m_handle.GetVersion(); }
 			auto operator()() -> U& {return GetReference()(); }
 			auto operator=(T&& value) -> void { GetReference()() = std::forward<T>(value); }
 			     operator T&() { return GetReference(); }
@@ -115,9 +114,9 @@ namespace vecs {
 
 		private:
 			auto GetReference() -> T& {
-				auto arch = m_slot->m_value.m_arch;
-				auto index = m_slot->m_value.m_index;
-				if( !m_slot || m_slot->m_version != m_handle.GetVersion() || ( arch != m_archetype && !arch->Has(Type<T>()) ) ) {
+				auto arch = m_value->m_arch;
+				auto index = m_value->m_index;
+				if( !m_version || *m_version != m_handle.GetVersion() || ( arch != m_archetype && !arch->template Has<T>() ) ) {
 					std::cout << "Reference to type " << typeid(std::declval<T>()).name() << " invalidated because of adding or erasing a component or erasing an entity!" << std::endl;
 					assert(false);
 					exit(-1);
@@ -129,7 +128,8 @@ namespace vecs {
 			}
 
 			Handle m_handle{};
-			Slot_t* m_slot{nullptr};
+			Version_t* m_version{nullptr};
+			Archetype::ArchetypeAndIndex* m_value{nullptr};
 			Archetype *m_archetype{nullptr};
 		};
 
@@ -151,6 +151,7 @@ namespace vecs {
 
 
 		/// @brief Used for iterating over entity components. Iterators are created by a view. 
+		/// The component maps of an archetype are looked up once when the iterator enters the archetype.
 		template<typename... Ts>
 		class Iterator {
 
@@ -158,14 +159,16 @@ namespace vecs {
 			/// @brief Iterator constructor saving a list of archetypes and the current index.
 			/// @param arch List of archetypes. 
 			/// @param archidx First archetype index.
-			Iterator( Registry& system, std::vector<ArchetypeAndSize>& arch, size_t archidx) 
+			Iterator( RegistryT& system, std::vector<ArchetypeAndSize>& arch, size_t archidx) 
 				: m_registry(system), m_archetypes{arch}, m_archidx{archidx}, m_entidx{0} {
 				m_archidx>0 ? m_end = true : m_end = false;
+				GetMaps();
 			}
 
 			/// @brief Copy constructor.
 			Iterator(const Iterator& other) 
-				: m_registry{other.m_registry}, m_archetypes{other.m_archetypes}, m_archidx{other.m_archidx}, m_entidx{other.m_entidx} {
+				: m_registry{other.m_registry}, m_mapHandle{other.m_mapHandle}, m_maps{other.m_maps}, m_archetypes{other.m_archetypes}, 
+					m_archidx{other.m_archidx}, m_entidx{other.m_entidx} {
 
 			}
 
@@ -185,6 +188,7 @@ namespace vecs {
 					m_registry.FillGaps(m_archetypes[m_archidx].m_arch);
 					++m_archidx;
 					if( m_archidx >= m_archetypes.size() ) { break; }
+					GetMaps();
 				}
 				return *this;
 			}
@@ -196,7 +200,7 @@ namespace vecs {
 					Archetype::m_iteratingIndex = m_entidx;
 				}
 
-				auto tup = std::make_tuple( Get<Ts>()... );
+				auto tup = std::apply( [&](auto*... maps) { return std::make_tuple( Get<Ts>(maps)... ); }, m_maps );
 				if constexpr (sizeof...(Ts) == 1) { return std::get<0>(tup); }
 				else return tup;
 			}
@@ -208,22 +212,30 @@ namespace vecs {
 
 		private:
 
+			/// @brief Look up the component maps of the current archetype.
+			void GetMaps() {
+				if( m_archidx >= m_archetypes.size() ) { return; }
+				auto arch = m_archetypes[m_archidx].m_arch;
+				m_maps = std::make_tuple( arch->template Map<Ts>()... );
+				m_mapHandle = arch->template Map<Handle>();
+			}
+
 			template<typename T>
 				requires (!std::is_reference_v<T>)
-			auto Get() -> T {
-				return (*m_archetypes[m_archidx].m_arch->template Map<T>())[m_entidx];
+			auto Get(Vector<std::decay_t<T>>* map) -> T {
+				return (*map)[m_entidx];
 			}
 
 			template<typename T>
 				requires std::is_reference_v<T>
-			auto Get() -> to_ref_t<T> {
-				auto arch = m_archetypes[m_archidx].m_arch;
-				Handle handle = (*arch->template Map<Handle>())[m_entidx];
+			auto Get([[maybe_unused]] Vector<std::decay_t<T>>* map) -> to_ref_t<T> {
+				Handle handle = (*m_mapHandle)[m_entidx];
 				return to_ref_t<T>( handle, m_registry.GetSlot(handle));
 			}
 
-			Registry& m_registry; ///< Reference to the registry system.
+			RegistryT& m_registry; ///< Reference to the registry system.
 			Vector<Handle>*	m_mapHandle{nullptr}; ///< Pointer to the comp map holding the handle of the current archetype.
+			std::tuple<Vector<std::decay_t<Ts>>*...> m_maps; ///< Pointers to the comp maps of the current archetype.
 			std::vector<ArchetypeAndSize>& m_archetypes; ///< List of archetypes.
 			size_t 	m_end{false};	///< True if this is the end iterator.
 			size_t 	m_archidx{0};	///< Index of the current archetype.
@@ -239,27 +251,24 @@ namespace vecs {
 		class View {
 
 		public:
-			View(Registry& system, HashMap_t& map, auto&& tagsYes, auto&& tagsNo ) : 
-				m_system{system}, m_map(map), m_tagsYes{tagsYes}, m_tagsNo{tagsNo} {
-			} ///< Constructor.
+			/// @brief Constructor, turns the types and tags into signatures that archetypes are matched against.
+			/// Tags are looked up without handing out IDs. A required tag without an ID makes the view empty.
+			View(RegistryT& system, Directory_t& map, auto&& tagsYes, auto&& tagsNo ) : 
+				m_system{system}, m_yes{TypeSignature<Ts...>()}, m_no{FindTagSignature(tagsNo)}, m_map(map), 
+				m_ids{TypeId<Ts>()...} {
+				for( auto tag : tagsYes ) { 
+					auto id = TypeIds::Find(tag);
+					if( id == NO_ID ) { m_empty = true; continue; } //no archetype has the tag
+					m_yes.set(id);
+					m_ids.push_back(id); 
+				}
+			}
 
 			/// @brief Get an iterator to the first entity. 
 			/// The archetype is locked in shared mode to prevent changes. 
 			/// @return Iterator to the first entity.
 			auto begin() {
-				m_archetypes.clear();
-				for( auto& map : m_map ) { //go through all archetypes
-					auto arch = map.second.get();
-					if( arch->Size() == 0 ) { continue; } //skip empty archetypes
-					bool hasTypes = (arch->Has(Type<Ts>()) && ...); //should have all types
-					bool hasAllTagsYes = true; //should have all tags
-					bool hasNoTagsNo = true; //should not have any of these tags
-					for( auto& tag : m_tagsYes ) { if( !arch->Has(tag) ) { hasAllTagsYes = false; break; } }
-					for( auto& tag : m_tagsNo ) { if( arch->Has(tag) ) { hasNoTagsNo = false; break; } }
-					if( hasTypes && hasAllTagsYes && hasNoTagsNo ) { //all conditions met
-						m_archetypes.push_back({arch, arch->Size()});
-					}
-				}
+				FindArchetypes();
 				return Iterator<Ts...>{m_system, m_archetypes, 0};
 			}
 
@@ -268,12 +277,59 @@ namespace vecs {
 				return Iterator<Ts...>{m_system, m_archetypes, m_archetypes.size()};
 			}
 
+			/// @brief Call a function for each run of entities whose components are contiguous in all component maps
+			/// of the view. The function gets one std::span per view type, all spans have the same length, so a system
+			/// can loop over them with a plain for loop. Entities must not be inserted or erased inside the function.
+			/// @param fun Function that is called with a std::span<std::decay_t<Ts>> for each type Ts.
+			void ForEachSpan(auto&& fun) {
+				FindArchetypes();
+				for( auto& archAndSize : m_archetypes ) {
+					auto arch = archAndSize.m_arch;
+					auto maps = std::make_tuple( arch->template Map<Ts>()... );
+					size_t number = arch->Number();
+					for( size_t index = 0; index < number; ) {
+						size_t count = number - index;
+						std::apply( [&](auto*... map) { ((count = std::min(count, map->Span(index).size())), ...); }, maps );
+						std::apply( [&](auto*... map) { fun( map->Span(index).first(count)... ); }, maps );
+						index += count;
+					}
+				}
+			}
+
 		private:
 
-			Registry& 				m_system;	///< Reference to the registry system.
-			std::vector<size_t> 			m_tagsYes;	///< List of tags that must be present.
-			std::vector<size_t> 			m_tagsNo;	///< List of tags that must not be present.
-			HashMap_t& 						m_map;		///< List of archetypes.
+			/// @brief Find all non-empty archetypes that have all types and tags of the view.
+			/// Only the archetypes of the rarest type or tag are tested.
+			void FindArchetypes() {
+				m_archetypes.clear();
+				if( m_empty ) { return; }
+				if( m_ids.empty() ) {
+					for( auto& archetype : m_map ) { Match(archetype.get()); }
+					return;
+				}
+				auto* rarest = &m_map.WithType(m_ids[0]);
+				for( auto id : m_ids ) { 
+					auto& list = m_map.WithType(id);
+					if( list.size() < rarest->size() ) { rarest = &list; }
+				}
+				for( auto arch : *rarest ) { Match(arch); }
+			}
+
+			/// @brief Add an archetype to the view if it is not empty and has all types and tags of the view.
+			void Match(Archetype* arch) {
+				if( arch->Size() == 0 ) { return; } //skip empty archetypes
+				auto& signature = arch->Signature();
+				if( (signature & m_yes) == m_yes && (signature & m_no).none() ) { //all types and tags, none of the excluded tags
+					m_archetypes.push_back({arch, arch->Size()});
+				}
+			}
+
+			RegistryT& 				m_system;	///< Reference to the registry system.
+			Signature_t 					m_yes;		///< Types and tags that must be present.
+			Signature_t 					m_no;		///< Tags that must not be present.
+			Directory_t& 					m_map;			///< List of archetypes.
+			std::vector<size_t> 			m_ids;			///< IDs of the types and tags that must be present.
+			bool							m_empty{false};	///< True if a required tag has no ID.
 			std::vector<ArchetypeAndSize>  	m_archetypes;	///< List of archetypes.
 		}; //end of View
 
@@ -282,18 +338,17 @@ namespace vecs {
 
 		template<typename... Ts> friend class Iterator;
 
-		Registry() { 
-			m_slotMaps.reserve(NUMBER_SLOTMAPS::value); //resize the slot storage
-			for( uint32_t i = 0; i < NUMBER_SLOTMAPS::value; ++i ) {
-				m_slotMaps.emplace_back( SlotMapAndMutex<typename Archetype::ArchetypeAndIndex>{ i, 6  } ); 
-			}
+		/// @brief Constructor, creates the registry.
+		/// @param chunkBytes If larger than 0, archetypes store their components in chunks of about this size, 
+		/// each holding all columns for a number of entities. If 0, each component is stored in its own Vector.
+		explicit RegistryT(size_t chunkBytes = 0) : m_chunkBytes{chunkBytes}, m_slotMaps{NUMBER_SLOTMAPS::value, 6} { 
 			//If it is in Debug Mode - connect to Console
 #ifdef _DEBUG
-			GetConsoleComm(this);
+			if constexpr (std::is_same_v<H, vecs::Handle>) { GetConsoleComm(this); }
 #endif
 		};
 
-		~Registry() = default;	///< Destructor.
+		~RegistryT() = default;	///< Destructor.
 
 		/// @brief Get the number of entities in the system.
 		/// @return The number of entities.
@@ -304,24 +359,59 @@ namespace vecs {
 		/// @brief Create an entity with components.
 		/// @tparam ...Ts The types of the components.
 		/// @param ...component The new values.
-		/// @return Handle of new entity.
+		/// @return Handle of new entity, or an invalid handle if the slot maps are full.
 		template<typename... Ts>
 			requires ((sizeof...(Ts) > 0) && (vtll::unique<vtll::tl<Ts...>>::value) && !vtll::has_type< vtll::tl<Ts...>, Handle>::value)
 		[[nodiscard]] auto Insert( Ts&&... component ) -> Handle {
-			size_t slotMapIndex = GetNewSlotmapIndex();
-			auto [handle, slot] = m_slotMaps[slotMapIndex].m_slotMap.Insert( {nullptr, 0} ); //get a slot for the entity
-			slot.m_value.m_arch = GetArchetype<Ts...>(nullptr, {}, {});
-			slot.m_value.m_index = slot.m_value.m_arch->Insert( handle, std::forward<Ts>(component)... ); //insert the entity into the archetype
+			auto arch = GetInsertArchetype<Ts...>(); //look up the archetype before taking a slot
+			auto result = m_slotMaps.TryInsert( typename Archetype::ArchetypeAndIndex{arch, 0} ); //get a slot for the entity in the home shard
+			if( !result ) { return Handle{}; }
+			auto [handle, slot] = *result;
+			slot.m_value.m_index = arch->Insert( handle, std::forward<Ts>(component)... ); //insert the entity into the archetype
 			++m_size;
 			return handle;
 		}
 
+		/// @brief Create a number of entities with the same component types. The slots are taken from the home shard in one run,
+		/// the archetype is looked up once, and the component columns are appended.
+		/// @tparam ...Ts The types of the components.
+		/// @param count Number of entities.
+		/// @param gen Generator called with the number of the entity, returning a std::tuple<Ts...> with its component values.
+		/// @return Handles of the new entities. If the slot maps are full, fewer entities are created.
+		template<typename... Ts>
+			requires ((sizeof...(Ts) > 0) && (vtll::unique<vtll::tl<Ts...>>::value) && !vtll::has_type< vtll::tl<Ts...>, Handle>::value)
+		[[nodiscard]] auto InsertBulk( size_t count, std::invocable<size_t> auto&& gen ) -> std::vector<Handle> {
+			return InsertBulk2<Ts...>(count, [&](Archetype* arch, std::span<const Handle> handles) { 
+				return arch->template InsertBulk<Ts...>(handles, gen); 
+			});
+		}
+
+		/// @brief Create a number of entities from spans of component values, one span per component type.
+		/// @tparam ...Ts The types of the components.
+		/// @param ...values The component values, all spans must have the same size.
+		/// @return Handles of the new entities. If the slot maps are full, fewer entities are created.
+		template<typename... Ts>
+			requires ((sizeof...(Ts) > 0) && (vtll::unique<vtll::tl<Ts...>>::value) && !vtll::has_type< vtll::tl<Ts...>, Handle>::value)
+		[[nodiscard]] auto InsertBulk( std::span<const Ts>... values ) -> std::vector<Handle> {
+			size_t count = std::get<0>(std::forward_as_tuple(values...)).size();
+			return InsertBulk2<Ts...>(count, [&](Archetype* arch, std::span<const Handle> handles) { 
+				return arch->template InsertBulk<Ts...>(handles, values.first(handles.size())...); 
+			});
+		}
+
 		/// @brief Test if an entity exists.
 		/// @param handle The handle of the entity.
 		/// @return true if the entity exists, else false.
 		bool Exists(Handle handle) {
-			auto& slot = GetSlot(handle);
-			return slot.m_version == handle.GetVersion();
+			return m_slotMaps.Exists(handle);
+		}
+
+		/// @brief Test a batch of handles for existence. Only the version arrays of the slot maps are read.
+		/// @param handles The handles of the entities.
+		/// @param result Receives 1 for each existing entity, and 0 otherwise. Must be at least as large as handles.
+		/// @return The number of existing entities.
+		auto Exists(std::span<const Handle> handles, std::span<uint8_t> result) -> size_t {
+			return m_slotMaps.Validate(handles, result);
 		}
 
 		/// @brief Test if an entity has a component.
@@ -332,7 +422,7 @@ namespace vecs {
 		bool Has(Handle handle) {
 			assert(Exists(handle));
 			auto arch = GetArchetypeAndIndex(handle).m_arch;
-			return arch->Has(Type<T>());
+			return arch->template Has<T>();
 		}
 
 		/// @brief Test if an entity has a tag.
@@ -397,21 +487,31 @@ namespace vecs {
 		/// @tparam ...Ts The types of the tags.
 		/// @param handle The handle of the entity.
 		/// @param ...tags The tags to add.
+		/// @return true if the tags were added, false if all VECS_MAX_TYPES IDs are used up.
 		template<typename... Ts>
 			requires (std::is_integral_v<std::decay_t<Ts>> && ...)
-		void AddTags(Handle handle, Ts... tags) {
-			AddTags(handle, std::vector<size_t>{tags...});
+		bool AddTags(Handle handle, Ts... tags) {
+			return AddTags(handle, std::vector<size_t>{tags...});
 		}
 		
-		/// @brief Add tags to an entity.
+		/// @brief Add tags to an entity. New tags get IDs, which are shared with the component types.
 		/// @param handle The handle of the entity.
 		/// @param tags The tags to add.
-		/// @param ...tags The tags to add.
-		void AddTags(Handle handle, const std::vector<size_t>&& tags) {
+		/// @return true if the tags were added, false if all VECS_MAX_TYPES IDs are used up.
+		bool AddTags(Handle handle, const std::vector<size_t>&& tags) {
 			auto& archAndIndex = GetArchetypeAndIndex(handle);
 			auto oldArch = archAndIndex.m_arch;
-			auto newArch = GetArchetype(oldArch, std::forward<decltype(tags)>(tags), {});
-			Move(newArch, oldArch, archAndIndex);
+			auto target = [&]{ return GetArchetype(oldArch, std::forward<decltype(tags)>(tags), {}); };
+			if( tags.size() == 1 ) {
+				auto id = TagId(tags[0]);
+				if( id == NO_ID ) { return false; }
+				MoveAlongEdge(archAndIndex, id, true, target);
+				return true;
+			}
+			auto signature = TagSignature(tags);
+			if( !signature ) { return false; }
+			MoveAlongEdge(archAndIndex, *signature, {}, target);
+			return true;
 		}
 
 		/// @brief Erase tags from an entity.
@@ -431,8 +531,13 @@ namespace vecs {
 		void EraseTags(Handle handle, const std::vector<size_t>&& tags) {
 			auto& archAndIndex = GetArchetypeAndIndex(handle);
 			auto oldArch = archAndIndex.m_arch;
-			auto newArch = GetArchetype(oldArch, {}, std::forward<decltype(tags)>(tags));
-			Move(newArch, oldArch, archAndIndex);
+			auto target = [&]{ return GetArchetype(oldArch, {}, std::forward<decltype(tags)>(tags)); };
+			if( tags.size() == 1 ) {
+				auto id = TypeIds::Find(tags[0]);
+				if( id != NO_ID ) { MoveAlongEdge(archAndIndex, id, false, target); } //a tag without ID is in no archetype
+				return;
+			}
+			MoveAlongEdge(archAndIndex, {}, FindTagSignature(tags), target);
 		}
 		
 		/// @brief Erase components from an entity.
@@ -443,25 +548,47 @@ namespace vecs {
 		void Erase(Handle handle) {
 			auto& archAndIndex = GetArchetypeAndIndex(handle);
 			auto arch = archAndIndex.m_arch;
-			assert( (arch->Has(Type<Ts>()) && ...) );
-			auto newArch = GetArchetype(arch, {}, std::vector<size_t>{Type<Ts>()...});	
-			Move(newArch, arch, archAndIndex);		
+			assert( (arch->template Has<Ts>() && ...) );
+			MoveAlongTypeEdge<Ts...>(archAndIndex, false, [&]{ return GetArchetype(arch, {}, std::vector<size_t>{Type<Ts>()...}); });
 		}
 
 		/// @brief Erase an entity from the registry.
 		/// @param handle The handle of the entity.
 		void Erase(Handle handle) {
-			auto& slot = GetSlot(handle);
+			auto slot = GetSlot(handle);
 			auto& archAndIndex = slot.m_value;
 			ReindexMovedEntity(archAndIndex.m_arch->Erase(archAndIndex.m_index), archAndIndex.m_index);
-			slot.m_version++; //invalidate the slot
+			m_slotMaps.Erase(handle); //invalidate the slot and put it in the free list
 			--m_size;		
 		}
 
+		/// @brief Erase a number of entities. The entities are grouped by archetype, and each archetype compacts its rows
+		/// in one sweep, so no entity is moved more than once. Handles of entities that do not exist are ignored.
+		/// @param handles The handles of the entities.
+		void EraseBulk(std::span<const Handle> handles) {
+			std::vector<std::pair<Archetype*, std::vector<size_t>>> rows; //rows to erase per archetype
+			for( auto& handle : handles ) { 
+				if( !Exists(handle) ) continue; //erased before, or a duplicate
+				auto [arch, index] = GetArchetypeAndIndex(handle);
+				if( rows.empty() || rows.back().first != arch ) {
+					auto it = std::ranges::find(rows, arch, [](auto& r) { return r.first; });
+					if( it == rows.end() ) { rows.emplace_back(arch, std::vector<size_t>{}); }
+					else { std::iter_swap(it, rows.end() - 1); }
+				}
+				rows.back().second.push_back(index);
+				m_slotMaps.Erase(handle);
+				--m_size;
+			}
+			for( auto& [arch, indices] : rows ) {
+				std::sort(indices.begin(), indices.end());
+				arch->EraseBulk(indices, [&](Handle handle, size_t index) { ReindexMovedEntity(handle, index); });
+			}
+		}
+
 		/// @brief Clear the registry by removing all entities.
 		void Clear() {
-			for( auto& arch : m_archetypes ) { arch.second->Clear(); }
-			for( auto& slotmap : m_slotMaps ) { slotmap.m_slotMap.Clear(); }
+			for( auto& arch : m_archetypes ) { arch->Clear(); }
+			m_slotMaps.Clear();
 			m_size = 0;
 		}
 
@@ -479,9 +606,9 @@ namespace vecs {
 		void Print() {
 			std::cout << "-----------------------------------------------------------------------------------------------" << std::endl;
 			std::cout << "Entities: " << Size() << std::endl;
-			for( auto& it : m_archetypes ) {
-				std::cout << "Archetype Hash: " << it.first << std::endl;
-				it.second->Print();
+			for( auto& arch : m_archetypes ) {
+				std::cout << "Archetype Hash: " << Directory_t::HashOf(arch->Signature()) << std::endl;
+				arch->Print();
 			}
 			std::cout << std::endl << std::endl;
 		}
@@ -489,8 +616,7 @@ namespace vecs {
 		/// @brief Validate the registry.
 		/// Make sure all archetypes have the same size in all component maps.
 		void Validate() {
-			for( auto& it : m_archetypes ) { 
-				auto arch = it.second.get();
+			for( auto& arch : m_archetypes ) { 
 				arch->Validate();
 			}
 		}
@@ -498,7 +624,7 @@ namespace vecs {
 		/// @brief Get the mutex of the archetype.
 		/// @return Reference to the mutex.
 		[[nodiscard]] inline auto GetSlotMapMutex(size_t index) -> Mutex_t& {
-			return m_slotMaps[index].m_mutex;
+			return m_slotMaps.GetShard(index).m_mutex;
 		}
 
 		/// @brief Get the mutex of the archetype.
@@ -507,6 +633,22 @@ namespace vecs {
 			return m_mutex; 
 		}
 
+		/// @brief Get the segment pool that is shared by all component maps of the registry.
+		/// @return Reference to the segment pool.
+		[[nodiscard]] inline auto GetSegmentPool() -> SegmentPool& {
+			return m_segmentPool;
+		}
+
+		/// @brief Release the memory of the slots of erased entities at the end of the slot maps. 
+		/// This only works in a sequential registry (REGISTRYTYPE_SEQUENTIAL), whose SlotMap reuses the lowest free slots first,
+		/// so live slots stay packed at the front. The ConcurrentSlotMap of a parallel registry (REGISTRYTYPE_PARALLEL) reuses
+		/// slots in any order and never releases its segments, there this function does nothing and returns 0.
+		/// @return The number of released slots, always 0 in a parallel registry.
+		auto ShrinkToFit() -> size_t {
+			if constexpr (requires(SlotMaps_t& slotMaps) { slotMaps.ShrinkToFit(); }) { return m_slotMaps.ShrinkToFit(); }
+			return 0;
+		}
+
 		/// @brief Swap two entities.
 		/// @param h1 The handle of the first entity.
 		/// @param h2 The handle of the second entity.
@@ -538,18 +680,11 @@ namespace vecs {
 			return std::ranges::find(container, hs) != container.end();
 		}
 
-		/// @brief Add a type to a container, not yet in the container.
-		/// @param container The container to add to.
-		/// @param hs The type hash to add.
-		void AddType(auto&& container, size_t hs) {
-			if(!ContainsType( container, hs)) container.push_back(hs);
-		}
-
 		/// @brief Get the index of the entity in the archetype
 		/// @param handle The handle of the entity.
 		/// @return The index of the entity in the archetype.
-		auto GetSlot( Handle handle ) -> Slot_t& {
-			return m_slotMaps[handle.GetStorageIndex()].m_slotMap[handle];
+		auto GetSlot( Handle handle ) -> Slot_t {
+			return m_slotMaps[handle];
 		}
 
 		/// @brief Get the index of the entity in the archetype
@@ -559,45 +694,59 @@ namespace vecs {
 			return GetSlot(handle).m_value;
 		}
 
-		/// @brief Get a new index of the slotmap for the current thread.
-		/// @return New index of the slotmap.
-		size_t GetNewSlotmapIndex() {
-			m_slotMapIndex = (m_slotMapIndex + 1) & (NUMBER_SLOTMAPS::value - 1);
-			return m_slotMapIndex;
-		}
-		
-		/// @brief Create a list of type hashes
-		/// @param arch The archetype types to use
-		/// @param tags Use also these tag hashes
-		/// @return A vector of type hashes
+		/// @brief Create a number of entities. 
+		/// @param count Number of entities.
+		/// @param insert Function inserting the components of the entities into the archetype, returning the index of the first entity.
+		/// @return Handles of the new entities. If the slot maps are full, fewer entities are created.
 		template<typename... Ts>
-		auto CreateTypeList(Archetype* arch, const std::vector<size_t>&& tags, const std::vector<size_t>&& ignore) -> std::vector<size_t> {
-			std::vector<size_t> all{ tags.begin(), tags.end() };
-			(AddType(all, Type<Ts>()), ...);
-			if(arch) { for( auto type : arch->Types() ) { if(!ContainsType(ignore, type)) { AddType(all, type); } } }
-			return all;
+		auto InsertBulk2( size_t count, auto&& insert ) -> std::vector<Handle> {
+			std::vector<Handle> handles(count);
+			auto arch = GetInsertArchetype<Ts...>();
+			count = m_slotMaps.InsertBulk(std::span<Handle>{handles}, typename Archetype::ArchetypeAndIndex{arch, 0});
+			handles.resize(count);
+			size_t first = insert(arch, std::span<const Handle>{handles});
+			for( size_t i = 0; i < count; ++i ) { GetSlot(handles[i]).m_value.m_index = first + i; }
+			m_size += count;
+			return handles;
+		}
+
+		/// @brief Get the archetype for new entities with components Ts. The archetype is looked up once per type pack 
+		/// and cached in a vector indexed by the pack ID, so inserting finds it without building and hashing a type list.
+		/// Packs with the same types in a different order have their own entries, pointing to the same archetype.
+		/// @tparam ...Ts The component types.
+		/// @return A pointer to the archetype.
+		template<typename... Ts>
+		auto GetInsertArchetype() -> Archetype* {
+			size_t id = PackId<Ts...>();
+			if( id < m_insertArchetypes.size() && m_insertArchetypes[id] ) { return m_insertArchetypes[id]; }
+			if( id >= m_insertArchetypes.size() ) { m_insertArchetypes.resize(id + 1, nullptr); }
+			return m_insertArchetypes[id] = GetArchetype<Ts...>(nullptr, {}, {});
 		}
 
 		/// @brief Get an archetype with components.
 		/// @tparam ...Ts The component types.
 		/// @param arch Use the types of this archetype.
 		/// @param tags Should have the tags of the entity.
+		/// @param ignore Leave out these types and tags.
 		/// @return A pointer to the archetype.
 		template<typename... Ts>
 		auto GetArchetype(Archetype* arch, const std::vector<size_t>&& tags, const std::vector<size_t>&& ignore) -> Archetype* {
-			size_t hs = Hash(CreateTypeList<Ts...>(arch, std::forward<decltype(tags)>(tags), std::forward<decltype(ignore)>(ignore)));
-			if( m_archetypes.contains( hs ) ) { return m_archetypes[hs].get(); }
+			Signature_t signature = TypeSignature<Handle, Ts...>() | FindTagSignature(tags); //new tags got their IDs in AddTags()
+			if(arch) { signature |= arch->Signature(); }
+			signature &= ~FindTagSignature(ignore); //type hashes and tags share the IDs
+			if( auto found = m_archetypes.Find(signature) ) { return found; }
 
-			auto newArchUnique = std::make_unique<Archetype>();
+			auto newArchUnique = std::make_unique<Archetype>(&m_segmentPool);
 			auto newArch = newArchUnique.get();
 			if(arch) newArch->Clone(*arch, ignore); //clone old types/components and old tags
-			auto fun = [&]<typename T>(){ if( !ContainsType(newArch->Types(), Type<T>()) ) { newArch->template AddComponent<T>(); } };
+			[[maybe_unused]] auto fun = [&]<typename T>(){ if( !ContainsType(newArch->Types(), Type<T>()) ) { newArch->template AddComponent<T>(); } };
 			(fun.template operator()<Ts>(), ...);
 			for( auto tag : tags ) { 
 				if(!ContainsType(newArch->Types(), tag) && !ContainsType(ignore, tag)) { newArch->AddType(tag); } 
 			} //add new tags
-			m_archetypes[hs] = std::move(newArchUnique); //store the archetype
-			return newArch;
+			if( m_chunkBytes > 0 ) { newArch->UseChunks(m_chunkBytes); } //all components are known now
+			assert(newArch->Signature() == signature);
+			return m_archetypes.Insert(std::move(newArchUnique)); //store the archetype
 		}
 
 		/// @brief If a entity is moved or erased, the last entity of the archetype is moved to the empty slot.
@@ -610,14 +759,60 @@ namespace vecs {
 			archAndIndex.m_index = index;
 		}
 
-		/// @brief Move an entity to a new archetype.
-		/// @param newArch The new archetype.
-		/// @param oldArch The old archetype.
+		/// @brief Move an entity along an edge of its archetype, for adding and removing types and tags.
+		/// If the archetype has no such edge yet, the target archetype is found or created and the edge is cached.
+		/// So adding or removing the same components again costs a short search of the pack edges of the archetype.
+		/// If the types and tags do not change the archetype, the entity is not moved.
+		/// @param archAndIndex The archetype and index of the entity.
+		/// @param add IDs of the added types and tags.
+		/// @param remove IDs of the removed types and tags.
+		/// @param target Function returning the target archetype, called only if there is no edge yet.
+		/// @return The new archetype of the entity.
+		auto MoveAlongEdge(typename Archetype::ArchetypeAndIndex& archAndIndex, const Signature_t& add, const Signature_t& remove, auto&& target) -> Archetype* {
+			auto arch = archAndIndex.m_arch;
+			auto edge = arch->FindEdge(add, remove);
+			if( !edge ) { edge = &arch->AddEdge(add, remove, target()); }
+			return MoveAlongEdge(archAndIndex, *edge);
+		}
+
+		/// @brief Move an entity along the edge for adding or removing a single type or tag. These edges are
+		/// indexed by the type ID, so finding them costs no search.
+		/// @param archAndIndex The archetype and index of the entity.
+		/// @param id ID of the type or tag.
+		/// @param add true if the type or tag is added, false if it is removed.
+		/// @param target Function returning the target archetype, called only if there is no edge yet.
+		/// @return The new archetype of the entity.
+		auto MoveAlongEdge(typename Archetype::ArchetypeAndIndex& archAndIndex, size_t id, bool add, auto&& target) -> Archetype* {
+			auto arch = archAndIndex.m_arch;
+			auto edge = arch->FindEdge(id, add);
+			if( !edge ) { edge = &arch->AddEdge(id, add, target()); }
+			return MoveAlongEdge(archAndIndex, *edge);
+		}
+
+		/// @brief Move an entity along the edge for adding or removing component types, see MoveAlongEdge().
+		/// @tparam ...Ts The types of the components.
 		/// @param archAndIndex The archetype and index of the entity.
-		void Move(Archetype* newArch, Archetype* oldArch, vecs::Archetype::ArchetypeAndIndex& archAndIndex) {
-			auto [newIndex, movedHandle] = newArch->Move(*oldArch, archAndIndex.m_index);
+		/// @param add true if the types are added, false if they are removed.
+		/// @param target Function returning the target archetype, called only if there is no edge yet.
+		/// @return The new archetype of the entity.
+		template<typename... Ts>
+		auto MoveAlongTypeEdge(typename Archetype::ArchetypeAndIndex& archAndIndex, bool add, auto&& target) -> Archetype* {
+			if constexpr (sizeof...(Ts) == 1) { return MoveAlongEdge(archAndIndex, TypeId<Ts...>(), add, target); }
+			else if( add ) { return MoveAlongEdge(archAndIndex, TypeSignature<Ts...>(), {}, target); }
+			else { return MoveAlongEdge(archAndIndex, {}, TypeSignature<Ts...>(), target); }
+		}
+
+		/// @brief Move an entity to the target archetype of an edge.
+		/// @param archAndIndex The archetype and index of the entity.
+		/// @param edge The edge.
+		/// @return The new archetype of the entity.
+		auto MoveAlongEdge(typename Archetype::ArchetypeAndIndex& archAndIndex, const typename Archetype::Edge& edge) -> Archetype* {
+			auto arch = archAndIndex.m_arch;
+			if( edge.m_target == arch ) { return arch; } //e.g. a tag that the entity already has
+			auto [newIndex, movedHandle] = edge.m_target->Move(*arch, archAndIndex.m_index, *edge.m_plan);
 			ReindexMovedEntity(movedHandle, archAndIndex.m_index);
-			archAndIndex = { newArch, newIndex };
+			archAndIndex = { edge.m_target, newIndex };
+			return edge.m_target;
 		}
 
 		/// @brief Get component values of an entity.
@@ -627,24 +822,23 @@ namespace vecs {
 		template<typename... Ts>
 			requires (vtll::unique<vtll::tl<Ts...>>::value && !vtll::has_type< vtll::tl<Ts...>, Handle&>::value)
 		[[nodiscard]] auto Get2(Handle handle) {
-			auto& slot = GetSlot(handle);
+			auto slot = GetSlot(handle);
 			auto& archAndIndex = slot.m_value; //  GetArchetypeAndIndex(handle);
 			auto arch = archAndIndex.m_arch;
-			if( (arch->Has(Type<Ts>()) && ...) ) { return std::tuple<to_ref_t<Ts>...>{ Get3<Ts>(handle, slot)... }; } 
-			auto newArch = GetArchetype<Ts...>(arch, {}, {});
-			Move(newArch, arch, archAndIndex);
+			if( (arch->template Has<Ts>() && ...) ) { return std::tuple<to_ref_t<Ts>...>{ Get3<Ts>(handle, slot)... }; } 
+			MoveAlongTypeEdge<Ts...>(archAndIndex, true, [&]{ return GetArchetype<Ts...>(arch, {}, {}); });
 			return std::tuple<to_ref_t<Ts>...>{ Get3<Ts>(handle, slot)... }; 
 		}
 
 		template<typename T>
 			requires (!std::is_reference_v<T>)
-		auto Get3(Handle handle, Slot_t& slot ) -> T { //Archetype* arch, size_t index) -> T {
+		auto Get3([[maybe_unused]] Handle handle, Slot_t slot ) -> T { //Archetype* arch, size_t index) -> T {
 			return slot.m_value.m_arch->template Get<T>(slot.m_value.m_index);
 		}
 
 		template<typename T>
 		requires std::is_reference_v<T>
-		auto Get3(Handle handle, Slot_t& slot ) { //Archetype* arch, size_t index) {
+		auto Get3(Handle handle, Slot_t slot ) { //Archetype* arch, size_t index) {
 			return Ref<std::decay_t<T>>(handle, slot) ; //arch->template Get<Handle>(index), arch->template Get<std::decay_t<T>>(index));
 		}
 
@@ -656,17 +850,18 @@ namespace vecs {
 		void Put2(Handle handle, Ts&&... vs) {
 			auto& archAndIndex = GetArchetypeAndIndex(handle);
 			auto arch = archAndIndex.m_arch;
-			if( (arch->Has(Type<Ts>()) && ...) ) { arch->Put(archAndIndex.m_index, std::forward<Ts>(vs)...); return; }
-			auto newArch = GetArchetype<Ts...>(arch, {}, {});
-			Move(newArch, arch, archAndIndex);
+			if( (arch->template Has<Ts>() && ...) ) { arch->Put(archAndIndex.m_index, std::forward<Ts>(vs)...); return; }
+			auto newArch = MoveAlongTypeEdge<Ts...>(archAndIndex, true, [&]{ return GetArchetype<Ts...>(arch, {}, {}); });
 			newArch->Put(archAndIndex.m_index, std::forward<Ts>(vs)...);
 		}
 
 		Size_t m_size{0}; //number of entities
-		SlotMaps_t m_slotMaps; //Slotmap array for entities. Each slot map has its own mutex.
-		HashMap_t m_archetypes; //Mapping hash (from type hashes) to archetype 1:1. 
+		size_t m_chunkBytes{0}; //size of archetype chunks in bytes, 0 if components are stored in separate vectors
+		SlotMaps_t m_slotMaps; //Slotmap shards for entities. Each thread inserts into its home shard.
+		SegmentPool m_segmentPool; //Free segments shared by all archetypes, must outlive them.
+		Directory_t m_archetypes; //Mapping signature to archetype 1:1.
+		std::vector<Archetype*> m_insertArchetypes; //archetypes for inserting entities, indexed by the pack ID of the component types
 		Mutex_t m_mutex; //mutex for reading and writing m_archetypes.
-		inline static thread_local size_t m_slotMapIndex = NUMBER_SLOTMAPS::value - 1; //for new entities
 
 
 		// Console Communication
@@ -686,7 +881,7 @@ namespace vecs {
 		float GetAvgComp() {
 			float avgComp = 0.f;
 			for (auto& arch : m_archetypes) {
-				avgComp += arch.second->GetComponents();
+				avgComp += arch->GetComponents();
 			}
 			return (Size()) ? (avgComp / Size()) : Size();
 		}
@@ -696,7 +891,7 @@ namespace vecs {
 		size_t GetEstSize() {
 			size_t estSize = 0;
 			for (auto& arch : m_archetypes) {
-				estSize += arch.second->GetEstSize();
+				estSize += arch->GetEstSize();
 			}
 			return estSize;
 		}
@@ -718,10 +913,10 @@ namespace vecs {
 			json += std::to_string(Size()) + ",";
 			json += "\"archetypes\":[";
 			size_t art{ 0 };
-			for (auto& it : m_archetypes) {
+			for (auto& arch : m_archetypes) {
 				if (art) json += ",";
-				json += "{\"hash\":\"" + std::to_string(it.first) + "\"" +
-					"," + it.second->ToJSON() + "}";
+				json += "{\"hash\":\"" + std::to_string(Directory_t::HashOf(arch->Signature())) + "\"" +
+					"," + arch->ToJSON() + "}";
 				art++;
 			}
 			GetMutex().unlock();
@@ -731,6 +926,8 @@ namespace vecs {
 		}
 	};
 
+	using Registry = RegistryT<Handle>; ///< Registry with the default handle type.
+
 	template<typename T>
 	using Ref = Registry::Ref<T>;
 
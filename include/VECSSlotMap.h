@@ -6,100 +6,140 @@ namespace vecs {
 	//Slot Maps
 
 	/// @brief A slot map for storing a map from handle to archetype and index in the archetype.
-	/// A slot map can never shrink. If an entity is erased, the slot is added to the free list. A handle holds an index
-	/// to the slot map and a version counter. If the version counter of the slot is different from the version counter of the handle,
-	/// the slot is invalid.
+	/// If an entity is erased, the slot is marked as free. A handle holds an index to the slot map and a version counter. 
+	/// If the version counter of the slot is different from the version counter of the handle, the slot is invalid.
+	/// The slots are stored as structure of arrays: versions and values live in separate dense vectors, so version checks 
+	/// only touch 4 bytes per slot. Free slots are kept in a bitmap with one summary bit per 64 slots, and the lowest free 
+	/// slot is always used first. So live slots stay packed at the front, and ShrinkToFit() can release the free slots at the end.
 	/// @tparam T The value type of the slot map.
-	template<VecsPOD T>
+	/// @tparam H The handle type.
+	template<VecsPOD T, typename H = Handle>
 	class SlotMap {
+		static_assert(H::VERSION <= 32, "Slot versions are stored in 32 bits!");
 
 	public:
-		/// @brief A slot in the slot map.
-		struct Slot {
-			int64_t m_nextFree; //index of the next free slot in the free list. 
-			size_t m_version;	//version of the slot
-			T 	   m_value{};	//value of the slot
-
-			Slot() = default;
-
-			/// @brief Constructor, creates a slot.
-			/// @param next Next free slot in the free list.
-			/// @param version Version counter of the slot to avoid accessing erased slots.
-			/// @param value Value stored in the slot.
-			Slot(const int64_t& next, const size_t& version, T& value) : m_value{value} {
-				m_nextFree = next;
-				m_version = version;
-			}
-
-			Slot(const int64_t&& next, const size_t&& version, T&& value) : m_value{std::forward<T>(value)} {
-				m_nextFree = next;
-				m_version = version;
-			}
+		using Handle = H; ///< Type of the handles.
+		using Version_t = uint32_t; ///< Type of the version counters.
 
-			/// @brief Copy operator.
-			/// @param other The slot to copy.
-			Slot& operator=( const Slot& other ) {
-				m_nextFree = other.m_nextFree;
-				m_version = other.m_version;
-				m_value = other.m_value;
-				return *this;
-			}
+		/// @brief A slot in the slot map. This is a proxy referencing the version and the value of a slot.
+		struct Slot {
+			uint32_t& m_version;	//version of the slot
+			T& 		  m_value;		//value of the slot
 		};
 
 	public:
 
-		/// @brief Constructor, creates the slot map and prefills it with an empty list.
-		/// @param size Size of the initial slot map.
+		/// @brief Constructor, creates an empty slot map. Slots are created on demand above the high water mark, 
+		/// so slots that were never used are never written.
+		/// @param storageIndex Index of the slot map in the registry, stored in handles.
+		/// @param bits Memory for 2^bits slots is reserved.
 		SlotMap(uint32_t storageIndex, int64_t bits) : m_storageIndex{storageIndex} {
-			m_firstFree = 0;
-			int64_t size = ((int64_t)1l << bits);
-			for( int64_t i = 1; i <= size-1; ++i ) { //create the free list
-				m_slots.push_back( Slot(int64_t{i}, size_t{0}, T{} ) );
-			}
-			m_slots.push_back( Slot(int64_t{-1}, size_t{0}, T{}) ); //last slot
+			Reserve((size_t)1 << bits);
 		}
 
+		/// @brief Copy constructor, creates an empty slot map with the same reserved memory.
 		SlotMap( const SlotMap& other ) : m_storageIndex{other.m_storageIndex} {
-			m_firstFree = 0;
-			int64_t size = other.m_slots.size();
-			for( int64_t i = 1; i <= size-1; ++i ) { //create the free list
-				m_slots.push_back( Slot( int64_t{i}, size_t{0}, T{} ) );
-			}
-			m_slots.push_back( Slot(int64_t{-1}, size_t{0}, T{}) ); //last slot
+			Reserve(other.m_versions.size());
 		}
 		
 		~SlotMap() = default; ///< Destructor.
 		
-		/// @brief Insert a value to the slot map.
+		/// @brief Insert a value to the slot map. The slot map must not be full.
+		/// @param value The value to insert.
+		/// @return A pair of the handle and the slot.
+		template<typename U>
+		auto Insert(U&& value) -> std::pair<Handle, Slot> {
+			auto result = TryInsert(std::forward<U>(value));
+			assert(result);
+			return *result;
+		}
+
+		/// @brief Insert a value to the slot map, if it is not full.
 		/// @param value The value to insert.
-		/// @return A pair of the handle and reference to the slot.
-		auto Insert(T& value) -> std::pair<Handle, Slot&> {
-			auto [handle, slot] = Insert2(std::forward<T>(value));
-			slot.m_value = value;
-			return {handle, slot};		
+		/// @return A pair of the handle and the slot, or std::nullopt if all slot indices are in use.
+		template<typename U>
+		auto TryInsert(U&& value) -> std::optional<std::pair<Handle, Slot>> {
+			int64_t index = TakeLowestFree();
+			if( index < 0 ) { 
+				index = m_versions.size(); //index of the new slot
+				if( (size_t)index >= Capacity() ) { return std::nullopt; }
+				Grow(index + 1);
+			}
+			++m_size;
+			m_values[index] = std::forward<U>(value);
+			return std::pair<Handle, Slot>{ Handle{ (size_t)index, m_versions[index], m_storageIndex}, Slot{ m_versions[index], m_values[index] } };	
 		}
 
-		auto Insert(T&& value) -> std::pair<Handle, Slot&> {
-			auto [handle, slot] = Insert2(std::forward<T>(value));
-			slot.m_value = std::forward<T>(value);
-			return {handle, slot};				
+		/// @brief Insert a number of slots with the same value. Free slots are used first, the rest is appended
+		/// to the arrays in one go.
+		/// @param handles Receives the handles of the new slots, one per slot.
+		/// @param value The value of the new slots.
+		/// @return The number of inserted slots. This is less than the number of handles if the slot map is full,
+		/// then only the first handles are set.
+		auto InsertBulk(std::span<Handle> handles, const T& value) -> size_t {
+			size_t i = 0;
+			for( int64_t index; i < handles.size() && (index = TakeLowestFree()) > -1; ++i ) {
+				m_values[index] = value;
+				handles[i] = Handle{ (size_t)index, m_versions[index], m_storageIndex };
+			}
+			size_t start = m_versions.size();
+			size_t rest = std::min(handles.size() - i, Capacity() - start);
+			Grow(start + rest);
+			m_values.fill(start, rest, value);
+			size_t number = i + rest;
+			for( size_t index = start; i < number; ++i, ++index ) { handles[i] = Handle{ (size_t)index, m_versionFloor, m_storageIndex }; }
+			m_size += number;
+			return number;
 		}
 
 		/// @brief Erase a value from the slot map.
 		/// @param handle The handle of the value to erase.
 		void Erase(Handle handle) {
-			auto& slot = m_slots[handle.GetIndex()];
-			++slot.m_version;	//increment the version to invalidate the slot
-			slot.m_nextFree = m_firstFree;	
-			m_firstFree = handle.GetIndex(); //add the slot to the free list
+			auto index = handle.GetIndex();
+			m_versions[index] = (m_versions[index] + 1) & H::VERSION_MASK;	//increment the version to invalidate the slot
+			MarkFree(index);
 			--m_size;
 		}
 
 		/// @brief Get a value from the slot map. Do not assert versions here, could be used for writing!
 		/// @param handle The handle of the value to get.
-		/// @return Reference to the value.
-		auto operator[](Handle handle) -> Slot& {
-			return m_slots[handle.GetIndex()];
+		/// @return Slot referencing the version and the value.
+		auto operator[](Handle handle) -> Slot {
+			auto index = handle.GetIndex();
+			return { m_versions[index], m_values[index] };
+		}
+
+		/// @brief Get the version of a slot. This only reads the version array.
+		/// @param handle The handle of the slot.
+		/// @return Reference to the version of the slot.
+		auto Version(Handle handle) -> uint32_t& {
+			return m_versions[handle.GetIndex()];
+		}
+
+		/// @brief Test whether a handle refers to a live slot. Only touches the 4 byte version of the slot.
+		/// @param handle The handle to test.
+		/// @return true if the version of the handle matches the version of the slot.
+		bool Exists(Handle handle) {
+			auto index = handle.GetIndex();
+			return index < m_versions.size() && m_versions[index] == handle.GetVersion();
+		}
+
+		/// @brief Validate a batch of handles. The handles are compared against the version array span by span,
+		/// so the inner loop is a plain gather and compare that the compiler can vectorize.
+		/// @param handles The handles to validate. They must belong to this slot map.
+		/// @param result Receives 1 for each valid handle, and 0 otherwise. Must be at least as large as handles.
+		/// @return The number of valid handles.
+		auto Validate(std::span<const Handle> handles, std::span<uint8_t> result) -> size_t {
+			assert(result.size() >= handles.size());
+			size_t size = m_versions.size();
+			size_t valid = 0;
+			for( size_t i = 0; i < handles.size(); ++i ) {
+				size_t index = handles[i].GetIndex();
+				uint8_t ok = index < size && m_versions[index] == (uint32_t)handles[i].GetVersion();
+				result[i] = ok;
+				valid += ok;
+			}
+			return valid;
 		}
 
 		/// @brief Get the size of the slot map.
@@ -108,42 +148,581 @@ namespace vecs {
 			return m_size;
 		}
 
-		/// @brief Clear the slot map. This puts all slots in the free list.
+		/// @brief A sequential slot map is never contended.
+		/// @return false.
+		static bool Contended() {
+			return false;
+		}
+
+		/// @brief Get the maximum number of slots, limited by the index bits of the handles.
+		/// @return The number of slots.
+		static constexpr auto Capacity() -> size_t {
+			return (size_t)H::INDEX_MASK + 1;
+		}
+
+		/// @brief Get the high water mark, i.e., the number of slots that are currently allocated.
+		/// @return The number of slots.
+		auto HighWater() const -> size_t {
+			return m_versions.size();
+		}
+
+		/// @brief Reserve memory for a number of slots in one pass. The slots are created when they are needed.
+		/// @param n Number of slots.
+		void Reserve(size_t n) {
+			m_versions.reserve(n);
+			m_values.reserve(n);
+		}
+
+		/// @brief Release the free slots at the end of the slot map. Whole segments that are no longer used are freed.
+		/// Slots that are created again later start with a version above all released versions, so handles of erased
+		/// entities stay invalid.
+		/// @return The number of released slots.
+		auto ShrinkToFit() -> size_t {
+			size_t size = m_versions.size();
+			size_t n = size;
+			while( n > 0 && IsFree(n - 1) ) {
+				if( n % 64 == 0 && m_free[n / 64 - 1] == ~uint64_t{0} ) { n -= 64; } //skip whole free words
+				else { --n; }
+			}
+			for( size_t i = n; i < size; ++i ) { m_versionFloor = std::max(m_versionFloor, m_versions[i]); }
+			for( size_t i = n; i < std::min(size, (n + 63) / 64 * 64); ++i ) { m_free[i / 64] &= ~(uint64_t{1} << (i % 64)); }
+			m_versions.resize(n);
+			m_values.resize(n);
+			m_free.resize((n + 63) / 64);
+			m_summary.resize((m_free.size() + 63) / 64);
+			for( size_t w = m_free.size(); w < m_summary.size() * 64; ++w ) { m_summary.back() &= ~(uint64_t{1} << (w % 64)); }
+			if( !m_free.empty() && !m_free.back() ) { m_summary.back() &= ~(uint64_t{1} << ((m_free.size() - 1) % 64)); }
+			m_lowest = std::min(m_lowest, m_summary.size());
+			return size - n;
+		}
+
+		/// @brief Clear the slot map. This marks all slots as free.
 		void Clear() {
-			m_firstFree = 0;
 			m_size = 0;
-			size_t size = m_slots.size();
-			for( size_t i = 1; i <= size-1; ++i ) { 
-				m_slots[i-1].m_nextFree = i;
-				m_slots[i-1].m_version++;
+			size_t size = m_versions.size();
+			if( size == 0 ) { return; }
+			for( size_t i = 0; i < size; ++i ) { 
+				m_versions[i] = (m_versions[i] + 1) & H::VERSION_MASK;
+				MarkFree(i);
 			}
-			m_slots[size-1].m_nextFree = -1;
-			m_slots[size-1].m_version++;
 		}
 
 	private:
-		auto Insert2(const T&& value) -> std::pair<Handle, Slot&> {
-			int64_t index = m_firstFree;
-			Slot* slot = nullptr;
-			if( index > -1 ) { 
-				slot = &m_slots[index];
-				m_firstFree = slot->m_nextFree;
-				slot->m_nextFree = -1;
-			} else {
-				m_slots.push_back( Slot{ int64_t{-1}, size_t{0}, {} } );
-				index = m_slots.size() - 1; //index of the new slot
-				slot = &m_slots[index];
+		/// @brief Create new slots at the end. They are live and start with the version floor.
+		/// @param n The new number of slots.
+		void Grow(size_t n) {
+			size_t start = m_versions.size();
+			m_versions.resize(n);
+			m_versions.fill(start, n - start, m_versionFloor);
+			m_values.resize(n);
+			m_free.resize((n + 63) / 64, 0);
+			m_summary.resize((m_free.size() + 63) / 64, 0);
+		}
+
+		/// @brief Test whether a slot is free.
+		bool IsFree(size_t index) const {
+			return (m_free[index / 64] >> (index % 64)) & 1;
+		}
+
+		/// @brief Mark a slot as free.
+		void MarkFree(size_t index) {
+			size_t word = index / 64;
+			m_free[word] |= uint64_t{1} << (index % 64);
+			m_summary[word / 64] |= uint64_t{1} << (word % 64);
+			m_lowest = std::min(m_lowest, word / 64);
+		}
+
+		/// @brief Take the free slot with the lowest index. The summary bitmap is searched from the lowest summary word
+		/// that can have free slots. The words below are all full.
+		/// @return The index of the slot, or -1 if there is no free slot.
+		auto TakeLowestFree() -> int64_t {
+			if( m_size == m_versions.size() ) return -1;
+			for( ; m_lowest < m_summary.size(); ++m_lowest ) {
+				if( !m_summary[m_lowest] ) continue;
+				size_t word = m_lowest * 64 + std::countr_zero(m_summary[m_lowest]);
+				size_t index = word * 64 + std::countr_zero(m_free[word]);
+				m_free[word] &= m_free[word] - 1; //clear the lowest bit
+				if( !m_free[word] ) { m_summary[m_lowest] &= ~(uint64_t{1} << (word % 64)); }
+				return (int64_t)index;
 			}
-			++m_size;
-			return { Handle{ (uint32_t)index, (uint32_t)slot->m_version, m_storageIndex}, *slot};	
+			return -1;
 		}
 
 		size_t m_storageIndex{0}; ///< Index of the storage.
 		size_t m_size{0}; ///< Size of the slot map. This is the size of the Vector minus the free slots.
-		int64_t m_firstFree{-1}; ///< Index of the first free slot. If -1 then there are no free slots.
-		Vector<Slot> m_slots; ///< Container of slots.
+		uint32_t m_versionFloor{0}; ///< Version of new slots, above the versions of all released slots.
+		size_t m_lowest{0}; ///< Lowest word of the summary that can have free slots.
+		Vector<uint32_t> m_versions{SegmentBits<uint32_t>(SEGMENT_BYTES)}; ///< Versions of the slots.
+		Vector<T> m_values{SegmentBits<T>(SEGMENT_BYTES)}; ///< Values of the slots.
+		std::vector<uint64_t> m_free; ///< One bit per slot, set if the slot is free.
+		std::vector<uint64_t> m_summary; ///< One bit per word of m_free, set if the word has a free slot.
+	};
+
+
+
+
+	//----------------------------------------------------------------------------------------------
+	//Concurrent Slot Maps
+
+	constexpr size_t CACHE_LINE_SIZE = 64; ///< Data written by different threads is placed in different cache lines of this size.
+
+	/// @brief A slot map that can be used from many threads without a mutex. Insert, Erase and Exists are lock free.
+	/// The free list is a stack whose head is tagged with a counter, so a thread that is preempted between reading 
+	/// and swapping the head cannot corrupt the stack (ABA problem). Each slot has an atomic version counter. Erasing 
+	/// a slot swaps the version of the handle with the next version, so a handle can only be erased once.
+	/// Slots are stored in segments that are never moved. The first two segments hold 2^segmentBits slots, each further 
+	/// segment is twice as large as the one before. So the segment directory has a fixed number of entries, and segments are 
+	/// allocated on demand until the handle index bits are used up. Reading and writing the values themselves is not synchronized.
+	/// @tparam T The value type of the slot map.
+	/// @tparam H The handle type.
+	template<VecsPOD T, typename H = Handle>
+	class ConcurrentSlotMap {
+		static_assert(H::VERSION <= 32, "Slot versions are stored in 32 bits!");
+
+		using Index_t = typename H::value_t; ///< Type of slot indices in the free list.
+		static const Index_t EMPTY = H::INDEX_MASK; ///< End of the free list, the largest index of a handle is not used for slots.
+		static const size_t MAX_SEGMENTS = 64; ///< Number of entries of the segment directory.
+
+		/// @brief A segment holding versions, values and free list links of a number of slots.
+		struct Segment {
+			std::unique_ptr<std::atomic<uint32_t>[]> m_versions;
+			std::unique_ptr<T[]> m_values;
+			std::unique_ptr<std::atomic<Index_t>[]> m_nextFree;
+
+			Segment(size_t size) : m_versions{new std::atomic<uint32_t>[size]}, m_values{new T[size]{}}, 
+				m_nextFree{new std::atomic<Index_t>[size]} {
+				for( size_t i = 0; i < size; ++i ) { 
+					m_versions[i].store(0, std::memory_order_relaxed); 
+					m_nextFree[i].store(EMPTY, std::memory_order_relaxed); 
+				}
+			}
+		};
+
+	public:
+		using Handle = H; ///< Type of the handles.
+		using Version_t = std::atomic<uint32_t>; ///< Type of the version counters.
+
+		/// @brief A slot in the slot map. This is a proxy referencing the version and the value of a slot.
+		struct Slot {
+			std::atomic<uint32_t>& m_version;	//version of the slot
+			T& 					   m_value;		//value of the slot
+		};
+
+		/// @brief Constructor, creates an empty slot map.
+		/// @param storageIndex Index of the slot map in the registry, stored in handles.
+		/// @param bits Segments for 2^bits slots are allocated.
+		/// @param segmentBits The first segment holds 2^segmentBits slots.
+		ConcurrentSlotMap(uint32_t storageIndex, int64_t bits, size_t segmentBits = SegmentBits<uint32_t>(SEGMENT_BYTES)) 
+				: m_storageIndex{storageIndex}, m_segmentBits{std::min(segmentBits, H::INDEX)} {
+			for( auto& segment : m_segments ) { segment.store(nullptr, std::memory_order_relaxed); }
+			Reserve((size_t)1 << bits);
+		}
+
+		/// @brief Copy constructor, creates an empty slot map with the same parameters.
+		ConcurrentSlotMap( const ConcurrentSlotMap& other ) 
+			: ConcurrentSlotMap(other.m_storageIndex, 0, other.m_segmentBits) {}
+
+		/// @brief Destructor, frees the segments.
+		~ConcurrentSlotMap() {
+			for( auto& segment : m_segments ) { delete segment.load(std::memory_order_relaxed); }
+		}
+
+		/// @brief Insert a value to the slot map. The slot map must not be full.
+		/// @param value The value to insert.
+		/// @return A pair of the handle and the slot.
+		template<typename U>
+		auto Insert(U&& value) -> std::pair<Handle, Slot> {
+			auto result = TryInsert(std::forward<U>(value));
+			assert(result);
+			return *result;
+		}
+
+		/// @brief Insert a value to the slot map, if it is not full.
+		/// @param value The value to insert.
+		/// @return A pair of the handle and the slot, or std::nullopt if all slot indices are in use.
+		template<typename U>
+		auto TryInsert(U&& value) -> std::optional<std::pair<Handle, Slot>> {
+			auto result = Insert2();
+			if( result ) { result->second.m_value = std::forward<U>(value); }
+			return result;
+		}
+
+		/// @brief Insert a number of slots with the same value. Free slots are popped first, the rest is taken
+		/// from above the high water mark with one atomic operation.
+		/// @param handles Receives the handles of the new slots, one per slot.
+		/// @param value The value of the new slots.
+		/// @return The number of inserted slots. This is less than the number of handles if the slot map is full,
+		/// then only the first handles are set.
+		auto InsertBulk(std::span<Handle> handles, const T& value) -> size_t {
+			size_t i = 0;
+			size_t retries = 0;
+			for( size_t index = 0; i < handles.size() && (index = Pop()) != EMPTY; ++i ) { 
+				handles[i] = Handle{ index, 0, 0 }; 
+				retries += m_retries;
+			}
+			size_t start = m_highWater.fetch_add(handles.size() - i, std::memory_order_acq_rel);
+			size_t number = i + std::min(handles.size() - i, Capacity() - std::min(start, Capacity()));
+			for( size_t index = start; i < number; ++i, ++index ) { handles[i] = Handle{ index, 0, 0 }; }
+			for( auto& handle : handles.first(number) ) {
+				auto [segment, offset] = Locate(handle.GetIndex());
+				segment->m_values[offset] = value;
+				handle = Handle{ handle.GetIndex(), segment->m_versions[offset].load(std::memory_order_acquire), m_storageIndex };
+			}
+			m_size.fetch_add(number, std::memory_order_relaxed);
+			m_retries = retries;
+			return number;
+		}
+
+		/// @brief Erase a value from the slot map. If several threads erase the same handle, only one succeeds.
+		/// @param handle The handle of the value to erase.
+		/// @return true if the handle was valid and has been erased, else false.
+		bool Erase(Handle handle) {
+			size_t index = handle.GetIndex();
+			uint32_t version = (uint32_t)handle.GetVersion();
+			if( index >= HighWater() ) return false;
+			if( !Versions(index).compare_exchange_strong(version, (version + 1) & H::VERSION_MASK, std::memory_order_acq_rel) ) return false;
+			Push(index);
+			m_size.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		/// @brief Get a value from the slot map. Do not assert versions here, could be used for writing!
+		/// @param handle The handle of the value to get.
+		/// @return Slot referencing the version and the value.
+		auto operator[](Handle handle) -> Slot {
+			auto [segment, offset] = Locate(handle.GetIndex());
+			return { segment->m_versions[offset], segment->m_values[offset] };
+		}
+
+		/// @brief Get the version of a slot.
+		/// @param handle The handle of the slot.
+		/// @return Reference to the version of the slot.
+		auto Version(Handle handle) -> std::atomic<uint32_t>& {
+			return Versions(handle.GetIndex());
+		}
+
+		/// @brief Test whether a handle refers to a live slot. Only touches the 4 byte version of the slot.
+		/// @param handle The handle to test.
+		/// @return true if the version of the handle matches the version of the slot.
+		bool Exists(Handle handle) {
+			auto index = handle.GetIndex();
+			return index < HighWater() && Versions(index).load(std::memory_order_acquire) == handle.GetVersion();
+		}
+
+		/// @brief Validate a batch of handles.
+		/// @param handles The handles to validate. They must belong to this slot map.
+		/// @param result Receives 1 for each valid handle, and 0 otherwise. Must be at least as large as handles.
+		/// @return The number of valid handles.
+		auto Validate(std::span<const Handle> handles, std::span<uint8_t> result) -> size_t {
+			assert(result.size() >= handles.size());
+			size_t valid = 0;
+			for( size_t i = 0; i < handles.size(); ++i ) {
+				uint8_t ok = Exists(handles[i]);
+				result[i] = ok;
+				valid += ok;
+			}
+			return valid;
+		}
+
+		/// @brief Get the size of the slot map.
+		/// @return The size of the slot map.
+		auto Size() const -> size_t {
+			return (size_t)m_size.load(std::memory_order_relaxed);
+		}
+
+		/// @brief Test whether the last insert or erase of the calling thread had to retry, because other threads
+		/// changed the free list at the same time.
+		/// @return true if the last operation was contended.
+		static bool Contended() {
+			return m_retries > 0;
+		}
+
+		/// @brief Get the maximum number of slots, limited by the index bits of the handles. The largest index marks the end of the free list.
+		/// @return The number of slots.
+		static constexpr auto Capacity() -> size_t {
+			return (size_t)EMPTY;
+		}
+
+		/// @brief Get the high water mark, i.e., the number of slots that have ever been used.
+		/// @return The number of slots.
+		auto HighWater() const -> size_t {
+			return std::min(m_highWater.load(std::memory_order_acquire), Capacity());
+		}
+
+		/// @brief Allocate the segments for a number of slots.
+		/// @param n Number of slots.
+		void Reserve(size_t n) {
+			n = std::min(n, Capacity());
+			for( size_t s = 0; s < MAX_SEGMENTS && SegmentStart(s) < n; ++s ) { GetSegment(s); }
+		}
+
+		/// @brief Clear the slot map. This puts all slots in the free list. Must not be called concurrently with other operations.
+		void Clear() {
+			m_size.store(0, std::memory_order_relaxed);
+			size_t size = HighWater();
+			if( size == 0 ) { return; }
+			for( size_t i = 0; i < size; ++i ) { 
+				auto [segment, offset] = Locate(i);
+				segment->m_nextFree[offset].store( i + 1 < size ? (Index_t)(i + 1) : EMPTY, std::memory_order_relaxed);
+				auto& version = segment->m_versions[offset];
+				version.store((version.load(std::memory_order_relaxed) + 1) & H::VERSION_MASK, std::memory_order_relaxed);
+			}
+			m_head.store( Tagged(Tag(m_head.load()) + 1, 0), std::memory_order_release);
+		}
+
+	private:
+		auto Insert2() -> std::optional<std::pair<Handle, Slot>> {
+			size_t index = Pop();
+			if( index == EMPTY ) { 
+				index = m_highWater.fetch_add(1, std::memory_order_acq_rel);
+				if( index >= Capacity() ) { return std::nullopt; }
+			}
+			m_size.fetch_add(1, std::memory_order_relaxed);
+			auto [segment, offset] = Locate(index);
+			auto& version = segment->m_versions[offset];
+			return std::pair<Handle, Slot>{ Handle{ index, version.load(std::memory_order_acquire), m_storageIndex}, Slot{ version, segment->m_values[offset] } };
+		}
+
+		/// @brief Push a slot onto the free stack.
+		void Push(size_t index) {
+			auto [segment, offset] = Locate(index);
+			auto& next = segment->m_nextFree[offset];
+			uint64_t head = m_head.load(std::memory_order_relaxed);
+			m_retries = 0;
+			next.store(Index(head), std::memory_order_relaxed);
+			while( !m_head.compare_exchange_weak(head, Tagged(Tag(head) + 1, index), std::memory_order_release, std::memory_order_relaxed) ) {
+				next.store(Index(head), std::memory_order_relaxed);
+				++m_retries;
+			}
+		}
+
+		/// @brief Pop a slot from the free stack. The link of the popped slot might be stale if another thread 
+		/// popped it in between, but then the tag has changed and the swap fails.
+		/// @return The index of the slot, or EMPTY if the stack is empty.
+		auto Pop() -> size_t {
+			uint64_t head = m_head.load(std::memory_order_acquire);
+			m_retries = 0;
+			while( Index(head) != EMPTY ) {
+				auto [segment, offset] = Locate(Index(head));
+				size_t next = segment->m_nextFree[offset].load(std::memory_order_relaxed);
+				if( m_head.compare_exchange_weak(head, Tagged(Tag(head) + 1, next), std::memory_order_acquire, std::memory_order_acquire) ) {
+					return Index(head);
+				}
+				++m_retries;
+			}
+			return EMPTY;
+		}
+
+		/// @brief The head of the free stack holds the index in the lower H::INDEX bits and the tag in the upper bits.
+		static auto Tagged(uint64_t tag, size_t index) -> uint64_t { return (tag << H::INDEX) | index; }
+		static auto Tag(uint64_t head) -> uint64_t { return head >> H::INDEX; }
+		static auto Index(uint64_t head) -> size_t { return head & H::INDEX_MASK; }
+
+		/// @brief Index of the first slot of a segment. Segment 0 starts at 0, segment s > 0 at 2^(segmentBits + s - 1).
+		auto SegmentStart(size_t s) const -> size_t { return s == 0 ? 0 : (size_t)1 << (m_segmentBits + s - 1); }
+
+		/// @brief Get the segment of a slot and the offset of the slot in the segment.
+		auto Locate(size_t index) -> std::pair<Segment*, size_t> {
+			size_t s = std::bit_width(index >> m_segmentBits);
+			return { GetSegment(s), index - SegmentStart(s) };
+		}
+
+		auto Versions(size_t index) -> std::atomic<uint32_t>& { 
+			auto [segment, offset] = Locate(index);
+			return segment->m_versions[offset]; 
+		}
+
+		/// @brief Get a segment. If it does not exist yet, it is allocated. If several threads allocate 
+		/// the same segment, one wins and the others free their segments.
+		/// @param s Index of the segment in the directory.
+		auto GetSegment(size_t s) -> Segment* {
+			auto& entry = m_segments[s];
+			Segment* segment = entry.load(std::memory_order_acquire);
+			if( segment ) return segment;
+			auto* created = new Segment(s == 0 ? (size_t)1 << m_segmentBits : SegmentStart(s));
+			if( entry.compare_exchange_strong(segment, created, std::memory_order_acq_rel) ) return created;
+			delete created;
+			return segment;
+		}
+
+		uint32_t m_storageIndex{0}; ///< Index of the storage.
+		size_t m_segmentBits; ///< Number of slots of the first segment (log2).
+		std::array<std::atomic<Segment*>, MAX_SEGMENTS> m_segments; ///< Segment directory.
+		alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_head{Tagged(0, EMPTY)}; ///< Head of the free stack, see Tagged().
+		alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_highWater{0}; ///< Number of slots that have ever been used.
+		std::atomic<int64_t> m_size{0}; ///< Number of live slots.
+		inline static thread_local size_t m_retries{0}; ///< Number of retries of the last insert or erase of this thread.
 	};
 
+	//----------------------------------------------------------------------------------------------
+	//Slot Map Shards
+
+	/// @brief A number of slot maps (shards) that are used together. Each thread inserts into its own home shard. 
+	/// Home shards are handed out to threads in turn, so up to number threads insert without sharing a shard.
+	/// If an insert of a thread was contended, or its home shard is full, the thread moves on to the next shard. 
+	/// Erasing and reading go to the shard stored in the handle. Each shard starts at a cache line boundary, so shards do not share cache lines.
+	/// @tparam S The slot map type, SlotMap or ConcurrentSlotMap.
+	template<typename S>
+	class SlotMapShards {
+
+	public:
+		using Handle = typename S::Handle; ///< Type of the handles.
+		using Slot = typename S::Slot;
+
+		/// @brief A shard, a slot map and a mutex.
+		struct alignas(CACHE_LINE_SIZE) Shard {
+			S m_slotMap;
+			Mutex_t m_mutex;
+			Shard( uint32_t storageIndex, int64_t bits ) : m_slotMap{storageIndex, bits}, m_mutex{} {};
+			Shard( const Shard& other ) : m_slotMap{other.m_slotMap}, m_mutex{} {};
+		};
+
+		/// @brief Constructor, creates the shards.
+		/// @param number Number of shards, must be a power of 2.
+		/// @param bits Memory for 2^bits slots is reserved in each shard.
+		SlotMapShards(size_t number, int64_t bits) {
+			assert(std::has_single_bit(number) && number - 1 <= Handle::STORAGE_MASK);
+			m_shards.reserve(number);
+			for( uint32_t i = 0; i < number; ++i ) { m_shards.emplace_back( Shard{ i, bits } ); }
+		}
+
+		/// @brief Insert a value into the home shard of the calling thread. The shards must not all be full.
+		/// @param value The value to insert.
+		/// @return A pair of the handle and the slot.
+		template<typename T>
+		auto Insert(T&& value) -> std::pair<Handle, Slot> {
+			auto result = TryInsert(std::forward<T>(value));
+			assert(result);
+			return *result;
+		}
+
+		/// @brief Insert a value into the home shard of the calling thread. If the home shard is full, 
+		/// the next shard becomes the home shard.
+		/// @param value The value to insert.
+		/// @return A pair of the handle and the slot, or std::nullopt if all shards are full.
+		template<typename T>
+		auto TryInsert(const T& value) -> std::optional<std::pair<Handle, Slot>> {
+			for( size_t tries = 0; tries < m_shards.size(); ++tries ) {
+				auto result = m_shards[Home()].m_slotMap.TryInsert(value);
+				if( !result ) { Next(); continue; }
+				if( S::Contended() ) { Spill(); }
+				return result;
+			}
+			return std::nullopt;
+		}
+
+		/// @brief Insert a number of slots with the same value into the home shard of the calling thread.
+		/// If the home shard is full, the rest is inserted into the next shards.
+		/// @param handles Receives the handles of the new slots, one per slot.
+		/// @param value The value of the new slots.
+		/// @return The number of inserted slots. This is less than the number of handles if all shards are full,
+		/// then only the first handles are set.
+		template<typename T>
+		auto InsertBulk(std::span<Handle> handles, const T& value) -> size_t {
+			size_t number = 0;
+			for( size_t tries = 0; tries < m_shards.size() && number < handles.size(); ++tries ) {
+				number += m_shards[Home()].m_slotMap.InsertBulk(handles.subspan(number), value);
+				if( number < handles.size() ) { Next(); }
+				else if( S::Contended() ) { Spill(); }
+			}
+			return number;
+		}
+
+		/// @brief Insert a value into a given shard.
+		/// @param shard Index of the shard.
+		/// @param value The value to insert.
+		/// @return A pair of the handle and the slot.
+		template<typename T>
+		auto InsertAt(size_t shard, T&& value) -> std::pair<Handle, Slot> {
+			return m_shards[shard & (m_shards.size() - 1)].m_slotMap.Insert(std::forward<T>(value));
+		}
+
+		/// @brief Erase a value from the shard it was inserted into.
+		/// @param handle The handle of the value to erase.
+		void Erase(Handle handle) {
+			m_shards[handle.GetStorageIndex()].m_slotMap.Erase(handle);
+		}
+
+		/// @brief Get a value. Do not assert versions here, could be used for writing!
+		/// @param handle The handle of the value to get.
+		/// @return Slot referencing the version and the value.
+		auto operator[](Handle handle) -> Slot {
+			return m_shards[handle.GetStorageIndex()].m_slotMap[handle];
+		}
+
+		/// @brief Test whether a handle refers to a live slot.
+		/// @param handle The handle to test.
+		/// @return true if the version of the handle matches the version of the slot.
+		bool Exists(Handle handle) {
+			return m_shards[handle.GetStorageIndex()].m_slotMap.Exists(handle);
+		}
+
+		/// @brief Validate a batch of handles.
+		/// @param handles The handles to validate.
+		/// @param result Receives 1 for each valid handle, and 0 otherwise. Must be at least as large as handles.
+		/// @return The number of valid handles.
+		auto Validate(std::span<const Handle> handles, std::span<uint8_t> result) -> size_t {
+			if( m_shards.size() == 1 ) { return m_shards[0].m_slotMap.Validate(handles, result); }
+			assert(result.size() >= handles.size());
+			size_t valid = 0;
+			for( size_t i = 0; i < handles.size(); ++i ) {
+				uint8_t ok = Exists(handles[i]);
+				result[i] = ok;
+				valid += ok;
+			}
+			return valid;
+		}
+
+		/// @brief Get the number of values in all shards.
+		auto Size() const -> size_t {
+			size_t size = 0;
+			for( auto& shard : m_shards ) { size += shard.m_slotMap.Size(); }
+			return size;
+		}
+
+		/// @brief Clear all shards.
+		void Clear() {
+			for( auto& shard : m_shards ) { shard.m_slotMap.Clear(); }
+		}
+
+		/// @brief Release the free slots at the end of each shard. Only available if the slot map type has ShrinkToFit(),
+		/// i.e., for SlotMap but not for ConcurrentSlotMap.
+		/// @return The number of released slots.
+		auto ShrinkToFit() -> size_t requires requires(S& slotMap) { slotMap.ShrinkToFit(); } {
+			size_t released = 0;
+			for( auto& shard : m_shards ) { released += shard.m_slotMap.ShrinkToFit(); }
+			return released;
+		}
+
+		/// @brief Get the number of shards.
+		auto Number() const -> size_t { return m_shards.size(); }
+
+		/// @brief Get a shard.
+		/// @param index Index of the shard.
+		auto GetShard(size_t index) -> Shard& { return m_shards[index]; }
 
+		/// @brief Get the home shard of the calling thread. A thread gets its home shard on its first insert.
+		/// @return Index of the home shard.
+		auto Home() -> size_t {
+			if( m_home == NO_SHARD ) { m_home = m_nextHome.fetch_add(1, std::memory_order_relaxed); }
+			return m_home & (m_shards.size() - 1);
+		}
+
+	private:
+		/// @brief Move the calling thread to the next shard handed out, because its home shard is contended.
+		void Spill() {
+			m_home = m_nextHome.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/// @brief Move the calling thread to the shard after its home shard, because its home shard is full.
+		void Next() {
+			m_home = Home() + 1;
+		}
+
+		static const size_t NO_SHARD = std::numeric_limits<size_t>::max();
+		std::vector<Shard> m_shards; ///< The shards.
+		inline static thread_local size_t m_home{NO_SHARD}; ///< Home shard of this thread.
+		inline static std::atomic<size_t> m_nextHome{0}; ///< Next home shard to hand out.
+	};
 
 }
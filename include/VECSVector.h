@@ -7,6 +7,7 @@ namespace vecs {
 	//Segmented Vector
 
 	template<VecsPOD T> class Vector;
+	class ChunkStore;
 
 	class VectorBase {
 
@@ -27,11 +28,17 @@ namespace vecs {
 		virtual auto pop_back() -> void = 0;
 		virtual auto erase(size_t index) -> size_t = 0;
 		virtual void copy(VectorBase* other, size_t from) = 0;
+		virtual auto relocate(VectorBase* other, size_t from) -> size_t = 0;
+		virtual void append_range(VectorBase* other, size_t first, size_t count) = 0;
+		virtual auto erase_range(size_t first, size_t count) -> size_t = 0;
+		virtual void resize(size_t n) = 0;
 		virtual void swap(size_t index1, size_t index2) = 0;
 		virtual auto size() const->size_t = 0;
+		virtual auto capacity() const->size_t = 0;
 		virtual auto clone() -> std::unique_ptr<VectorBase> = 0;
 		virtual void clear() = 0;
 		virtual void print() = 0;
+		virtual void attach(ChunkStore* store, size_t column) = 0;
 
 		//Methods for Console communication
 	public:
@@ -45,18 +52,304 @@ namespace vecs {
 		/// @brief get the Type hash for the Vector's elements.
 		/// @return Type hash.
 		virtual size_t GetType() = 0;
+		/// @brief get the dense type ID of the Vector's elements.
+		/// @return Type ID.
+		virtual size_t GetTypeId() = 0;
 		/// @brief get the base size of an element in the Vector.
 		/// @return element size.
 		virtual size_t ElemSize() = 0;
+		/// @brief get the alignment of an element in the Vector.
+		/// @return element alignment.
+		virtual size_t ElemAlign() = 0;
 
 	}; //end of VectorBase
 
 
+	/// @brief Alignment of a segment in bytes. Segments start on a cache line boundary.
+	inline constexpr size_t SEGMENT_ALIGNMENT = 64;
+
+	/// @brief Trait telling whether an object of type T can be moved to another address with memcpy, without calling its
+	/// move constructor and destructor. True for trivially copyable types. Specialize it to opt in other types whose
+	/// objects do not point into themselves, e.g. wrappers around std::unique_ptr.
+	/// @tparam T The type.
+	template<typename T>
+	struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+	template<typename T>
+	inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+	/// @brief Default target size of a full segment in bytes.
+	inline constexpr size_t SEGMENT_BYTES = 1ull << 14;
+
+	/// @brief Default size of the first segment in bytes. Following segments double in size until they reach SEGMENT_BYTES.
+	inline constexpr size_t SEGMENT_FIRST_BYTES = 1ull << 9;
+
+	/// @brief Default size of the virtual address range reserved for a mapped segment in bytes.
+	inline constexpr size_t MAPPED_BYTES = 1ull << 32;
+
+	/// @brief Whether mapped segments are available. On other platforms than Linux, SegmentMemory::Mapped and 
+	/// SegmentMemory::MappedHugePages fall back to heap segments of the normal sizes.
+#if defined(__linux__)
+	inline constexpr bool MAPPED_MEMORY = true;
+#else
+	inline constexpr bool MAPPED_MEMORY = false;
+#endif
+
+	/// @brief Where a Vector gets the memory of its segments from.
+	enum class SegmentMemory {
+		Heap,				///< Segments are allocated from the heap or the segment pool.
+		Mapped,				///< Segments are large virtual address ranges reserved with mmap, pages are committed when touched (Linux only, see MAPPED_MEMORY).
+		MappedHugePages		///< Like Mapped, and the kernel is asked to back the range with huge pages.
+	};
+
+	/// @brief Segment sizes of the component vectors of type T in an archetype. Specialize this to change the sizes for a type,
+	/// e.g. a page for large components. If firstBytes equals bytes, all segments have the same size.
+	/// For components of very large archetypes, memory can be set to SegmentMemory::Mapped. Then a column is a single
+	/// segment of mappedBytes reserved address space, elements never move and there are no small allocations.
+	/// @tparam T The component type.
+	template<typename T>
+	struct SegmentTraits {
+		static constexpr size_t bytes = SEGMENT_BYTES; ///< Target size of a full segment in bytes.
+		static constexpr size_t firstBytes = SEGMENT_FIRST_BYTES; ///< Size of the first segment in bytes.
+		static constexpr SegmentMemory memory = SegmentMemory::Heap; ///< Memory backend of the segments.
+		static constexpr size_t mappedBytes = MAPPED_BYTES; ///< Size of a mapped segment in bytes.
+	};
+
+	/// @brief Compute the number of segment bits such that a segment holds at most a number of bytes, but at least two elements.
+	/// @tparam T The element type.
+	/// @param bytes Maximum number of bytes of a segment.
+	/// @return Number of bits of the segment size.
+	template<typename T>
+	constexpr auto SegmentBits(size_t bytes) -> size_t {
+		size_t elements = bytes / sizeof(T);
+		return elements < 2 ? 1 : std::bit_width(elements) - 1;
+	}
+
+
+	//----------------------------------------------------------------------------------------------
+	//Segment Pool
+
+	/// @brief A pool of free segments, keyed by their size in bytes. A registry owns one pool that is shared by all
+	/// component vectors of its archetypes, so segments freed by one vector can be reused by any other vector.
+	/// The pool caches freed segments until it holds more than a high water mark of bytes, then it returns
+	/// segments to the system until it is down to the low water mark. Together with the spare segment kept
+	/// by each Vector, an entity count oscillating around a segment boundary never reaches the system allocator.
+	class SegmentPool {
+
+	public:
+		/// @brief Constructor, creates an empty pool.
+		/// @param highWater If more bytes than this are cached, the pool is trimmed.
+		/// @param lowWater The pool is trimmed down to this number of cached bytes.
+		SegmentPool(size_t highWater = 1ull << 26, size_t lowWater = 1ull << 25) : m_highWater{highWater}, m_lowWater{std::min(lowWater, highWater)} {}
+
+		SegmentPool(const SegmentPool&) = delete;
+		SegmentPool& operator=(const SegmentPool&) = delete;
+
+		/// @brief Destructor, returns all cached segments to the system.
+		~SegmentPool() { Clear(); }
+
+		/// @brief Get a segment of uninitialized memory, aligned to SEGMENT_ALIGNMENT.
+		/// @param bytes Size of the segment in bytes.
+		/// @return Pointer to the segment.
+		auto Allocate(size_t bytes) -> void* {
+			{
+				LockGuard<LOCKGUARDTYPE_REGISTRY> lock(&m_mutex);
+				auto it = m_free.find(bytes);
+				if (it != m_free.end() && !it->second.empty()) {
+					void* segment = it->second.back();
+					it->second.pop_back();
+					m_cachedBytes -= bytes;
+					++m_hits;
+					return segment;
+				}
+				++m_misses;
+			}
+			return ::operator new(bytes, std::align_val_t{ SEGMENT_ALIGNMENT });
+		}
+
+		/// @brief Return a segment to the pool.
+		/// @param segment Pointer to the segment.
+		/// @param bytes Size of the segment in bytes.
+		void Deallocate(void* segment, size_t bytes) {
+			LockGuard<LOCKGUARDTYPE_REGISTRY> lock(&m_mutex);
+			m_free[bytes].push_back(segment);
+			m_cachedBytes += bytes;
+			if (m_cachedBytes > m_highWater) { Trim(m_lowWater); }
+		}
+
+		/// @brief Return all cached segments to the system.
+		void Clear() {
+			LockGuard<LOCKGUARDTYPE_REGISTRY> lock(&m_mutex);
+			Trim(0);
+		}
+
+		/// @brief Get the number of allocations that were served from the pool.
+		auto Hits() const -> size_t { return m_hits; }
+
+		/// @brief Get the number of allocations that had to go to the system.
+		auto Misses() const -> size_t { return m_misses; }
+
+		/// @brief Get the number of bytes currently cached in the pool.
+		auto CachedBytes() const -> size_t { return m_cachedBytes; }
+
+	private:
+		/// @brief Return cached segments to the system until at most the given number of bytes is cached.
+		/// @param bytes Number of bytes that may stay in the pool.
+		void Trim(size_t bytes) {
+			for (auto& [size, segments] : m_free) {
+				while (m_cachedBytes > bytes && !segments.empty()) {
+					::operator delete(segments.back(), std::align_val_t{ SEGMENT_ALIGNMENT });
+					segments.pop_back();
+					m_cachedBytes -= size;
+				}
+			}
+		}
+
+		Mutex_t m_mutex; ///< Mutex for accessing the pool from several archetypes.
+		std::unordered_map<size_t, std::vector<void*>> m_free; ///< Free segments, keyed by their size in bytes.
+		size_t m_highWater; ///< Trim the pool if more bytes than this are cached.
+		size_t m_lowWater; ///< Trim the pool down to this number of bytes.
+		size_t m_cachedBytes{ 0 }; ///< Number of bytes currently cached.
+		size_t m_hits{ 0 }; ///< Number of allocations served from the pool.
+		size_t m_misses{ 0 }; ///< Number of allocations served by the system.
+	}; //end of SegmentPool
+
+
+	//----------------------------------------------------------------------------------------------
+	//Chunk Store
+
+	/// @brief Default size of a chunk in bytes.
+	inline constexpr size_t CHUNK_BYTES = 1ull << 14;
+
+	/// @brief Storage of an archetype in chunks. A chunk is one memory block holding the arrays of all component columns
+	/// of the archetype for the same 2^bits rows, one after the other, each starting on a cache line boundary.
+	/// The chunk starts with a header holding the number of rows in the chunk and a version that is increased each time
+	/// rows in the chunk are changed. Each column is a Vector whose segments are the column arrays in the chunks, so the
+	/// columns of a row are close to each other and a migration touches one chunk instead of one segment per column.
+	class ChunkStore {
+
+	public:
+		/// @brief Header at the start of each chunk.
+		struct Header {
+			size_t m_count{ 0 };	///< Number of rows in this chunk.
+			size_t m_version{ 0 };	///< Increased each time rows of this chunk are changed.
+			size_t m_users{ 0 };	///< Number of columns whose segment lies in this chunk.
+		};
+
+		/// @brief Constructor, computes the chunk layout for the given columns.
+		/// @param sizes Element sizes of the columns.
+		/// @param chunkBytes Target size of a chunk in bytes. Chunks hold at least 2 rows, so a chunk can be larger.
+		/// @param pool Pool for recycling chunks, or nullptr if chunks should come from the system.
+		ChunkStore(const std::vector<size_t>& sizes, size_t chunkBytes, SegmentPool* pool) : m_pool{ pool } {
+			size_t row = std::max(std::accumulate(sizes.begin(), sizes.end(), size_t{ 0 }), size_t{ 1 });
+			m_bits = std::max<size_t>(std::bit_width(std::max(chunkBytes / row, size_t{ 2 })) - 1, 1);
+			while (m_bits > 1 && Layout(sizes) > chunkBytes) { --m_bits; }
+			m_bytes = Layout(sizes);
+		}
+
+		ChunkStore(const ChunkStore&) = delete;
+		ChunkStore& operator=(const ChunkStore&) = delete;
+
+		/// @brief Destructor, all columns must have released their segments.
+		~ChunkStore() { assert(m_chunks.empty()); }
+
+		/// @brief Get the segment of a column in a chunk. Allocates the chunk if necessary.
+		/// Segments are acquired in order, so the chunk is either the last one or the next one.
+		/// @param chunk Index of the chunk.
+		/// @param column Index of the column.
+		/// @return Pointer to the segment.
+		auto Acquire(size_t chunk, size_t column) -> void* {
+			assert(chunk <= m_chunks.size());
+			if (chunk == m_chunks.size()) {
+				std::byte* memory = static_cast<std::byte*>(m_pool ? m_pool->Allocate(m_bytes) : ::operator new(m_bytes, std::align_val_t{ SEGMENT_ALIGNMENT }));
+				std::construct_at(reinterpret_cast<Header*>(memory));
+				m_chunks.push_back(memory);
+			}
+			++GetHeader(chunk).m_users;
+			return m_chunks[chunk] + m_offsets[column];
+		}
+
+		/// @brief Release the segment of a column in a chunk. Frees chunks at the end that have no more users.
+		/// @param chunk Index of the chunk.
+		void Release(size_t chunk) {
+			assert(chunk < m_chunks.size() && GetHeader(chunk).m_users > 0);
+			--GetHeader(chunk).m_users;
+			while (!m_chunks.empty() && GetHeader(m_chunks.size() - 1).m_users == 0) {
+				if (m_pool) { m_pool->Deallocate(m_chunks.back(), m_bytes); }
+				else { ::operator delete(m_chunks.back(), std::align_val_t{ SEGMENT_ALIGNMENT }); }
+				m_chunks.pop_back();
+			}
+		}
+
+		/// @brief Update the chunk headers after rows have been changed.
+		/// @param first Index of the first changed row.
+		/// @param last Index one past the last changed row.
+		/// @param oldRows Number of rows before the change.
+		/// @param newRows Number of rows after the change.
+		void Changed(size_t first, size_t last, size_t oldRows, size_t newRows) {
+			for (size_t chunk = first >> m_bits; chunk < m_chunks.size() && (chunk << m_bits) < last; ++chunk) {
+				++GetHeader(chunk).m_version;
+			}
+			size_t end = std::min(m_chunks.size(), (std::max(oldRows, newRows) >> m_bits) + 1);
+			for (size_t chunk = std::min(oldRows, newRows) >> m_bits; chunk < end; ++chunk) {
+				size_t start = chunk << m_bits;
+				GetHeader(chunk).m_count = newRows > start ? std::min(newRows - start, Rows()) : 0;
+			}
+		}
+
+		/// @brief Get the header of a chunk.
+		/// @param chunk Index of the chunk.
+		auto GetHeader(size_t chunk) -> Header& { return *reinterpret_cast<Header*>(m_chunks[chunk]); }
+
+		/// @brief Get the number of allocated chunks.
+		auto Number() const -> size_t { return m_chunks.size(); }
+
+		/// @brief Get the number of bits of the number of rows in a chunk.
+		auto Bits() const -> size_t { return m_bits; }
+
+		/// @brief Get the number of rows in a chunk.
+		auto Rows() const -> size_t { return 1ull << m_bits; }
+
+		/// @brief Get the size of a chunk in bytes.
+		auto Bytes() const -> size_t { return m_bytes; }
+
+	private:
+		/// @brief Compute the column offsets for the current number of rows.
+		/// @param sizes Element sizes of the columns.
+		/// @return Size of a chunk in bytes.
+		auto Layout(const std::vector<size_t>& sizes) -> size_t {
+			auto align = [](size_t bytes) { return (bytes + SEGMENT_ALIGNMENT - 1) & ~(SEGMENT_ALIGNMENT - 1); };
+			size_t offset = align(sizeof(Header));
+			m_offsets.clear();
+			for (auto size : sizes) {
+				m_offsets.push_back(offset);
+				offset += align(size << m_bits);
+			}
+			return offset;
+		}
+
+		SegmentPool* m_pool{ nullptr }; ///< Pool for recycling chunks.
+		size_t m_bits{ 1 }; ///< Number of rows in a chunk is 2^m_bits.
+		size_t m_bytes{ 0 }; ///< Size of a chunk in bytes.
+		std::vector<size_t> m_offsets; ///< Offsets of the column arrays in a chunk.
+		std::vector<std::byte*> m_chunks; ///< The chunks.
+	}; //end of ChunkStore
+
+
+	//----------------------------------------------------------------------------------------------
+	//Vector
+
 	/// @brief A vector that stores elements in segments to avoid reallocations. The size of a segment is 2^segmentBits.
+	/// Optionally the first segment is smaller, holding 2^firstSegmentBits elements, and the following segments double
+	/// in size until they reach 2^segmentBits. Then segment s starts at index 2^(firstSegmentBits+s-1), so small vectors
+	/// stay small while large vectors amortize allocation.
+	/// Segments are raw memory blocks aligned to SEGMENT_ALIGNMENT, and the segment table holds plain pointers to them.
+	/// Accessing an element thus needs only a shift, one load from the segment table and an offset.
+	/// Segment memory is uninitialized, elements are constructed in place when they are added and destroyed when they are removed.
 	template<VecsPOD T>
 	class Vector : public VectorBase {
 
-		using Segment_t = std::shared_ptr<std::vector<T>>;
+		using Segment_t = T*;
 		using Vector_t = std::vector<Segment_t>;
 
 	public:
@@ -76,67 +369,138 @@ namespace vecs {
 
 		/// @brief Constructor, creates the vector.
 		/// @param segmentBits The number of bits for the segment size.
-		Vector(size_t segmentBits = 6) : m_size{ 0 }, m_segmentBits(segmentBits), m_segmentSize{ 1ull << segmentBits }, m_segments{} {
+		/// @param pool Pool for recycling segments, or nullptr if segments should come from the system.
+		/// @param firstSegmentBits The number of bits for the size of the first segment, 0 means that all segments have the same size.
+		/// @param memory Memory backend of the segments. Mapped segments all have the same size and do not use the pool.
+		/// Without MAPPED_MEMORY the segments come from the heap.
+		Vector(size_t segmentBits = 6, SegmentPool* pool = nullptr, size_t firstSegmentBits = 0, SegmentMemory memory = SegmentMemory::Heap) 
+			: m_size{ 0 }, m_segmentBits(segmentBits), m_segmentSize{ 1ull << segmentBits }
+			, m_firstBits{ firstSegmentBits > 0 && firstSegmentBits < segmentBits && memory == SegmentMemory::Heap ? firstSegmentBits : segmentBits }
+			, m_geomLimit{ m_firstBits < m_segmentBits ? m_segmentSize : 0 }, m_pool{ pool }
+			, m_memory{ MAPPED_MEMORY ? memory : SegmentMemory::Heap }, m_segments{} {
 			assert(segmentBits > 0);
-			m_segments.emplace_back(std::make_shared<std::vector<T>>(m_segmentSize));
+			m_segments.emplace_back(AllocateSegment());
+		}
+
+		/// @brief Destructor, destroys all elements and frees the segments.
+		~Vector() {
+			Destroy(0, m_size);
+			while (!m_segments.empty()) { FreeLastSegment(); }
+		}
+
+		/// @brief Copy constructor, copies all elements into new segments.
+		Vector(const Vector& other) : m_size{ 0 }, m_segmentBits(other.m_segmentBits), m_segmentSize{ other.m_segmentSize }
+			, m_firstBits{ other.m_firstBits }, m_geomLimit{ other.m_geomLimit }, m_pool{ other.m_pool }, m_memory{ other.m_memory }, m_segments{} { //the copy does not use chunks
+			m_segments.emplace_back(AllocateSegment());
+			for (size_t i = 0; i < other.m_size; ++i) { emplace_back(other[i]); }
+		}
+
+		/// @brief Move constructor, takes over the segments of the other vector.
+		Vector(Vector&& other) noexcept : m_size{ other.m_size }, m_segmentBits(other.m_segmentBits), m_segmentSize{ other.m_segmentSize }
+			, m_firstBits{ other.m_firstBits }, m_geomLimit{ other.m_geomLimit }, m_pool{ other.m_pool }, m_memory{ other.m_memory }
+			, m_store{ other.m_store }, m_column{ other.m_column }, m_segments{ std::move(other.m_segments) } {
+			other.m_size = 0;
+			other.m_segments.clear();
 		}
 
-		~Vector() = default;
+		/// @brief Assignment operator, copy and swap.
+		Vector& operator=(Vector other) noexcept {
+			std::swap(m_size, other.m_size);
+			std::swap(m_segmentBits, other.m_segmentBits);
+			std::swap(m_segmentSize, other.m_segmentSize);
+			std::swap(m_firstBits, other.m_firstBits);
+			std::swap(m_geomLimit, other.m_geomLimit);
+			std::swap(m_pool, other.m_pool);
+			std::swap(m_memory, other.m_memory);
+			std::swap(m_store, other.m_store);
+			std::swap(m_column, other.m_column);
+			std::swap(m_segments, other.m_segments);
+			return *this;
+		}
 
-		Vector(const Vector& other) : m_size{ other.m_size }, m_segmentBits(other.m_segmentBits), m_segmentSize{ other.m_segmentSize }, m_segments{} {
-			m_segments.emplace_back(std::make_shared<std::vector<T>>(m_segmentSize));
+		/// @brief Construct a new element in place at the back of the vector.
+		/// @param ...args Arguments for the constructor of the element.
+		/// @return The index of the new element.
+		template<typename... Args>
+		auto emplace_back(Args&&... args) -> size_t {
+			while (Segment(m_size) >= m_segments.size()) {
+				m_segments.emplace_back(AllocateSegment());
+			}
+			std::construct_at(&m_segments[Segment(m_size)][Offset(m_size)], std::forward<Args>(args)...);
+			return m_size++;
 		}
 
 		/// @brief Push a value to the back of the vector.
 		/// @param value The value to push.
 		template<typename U>
 		auto push_back(U&& value) -> size_t {
-			while (Segment(m_size) >= m_segments.size()) {
-				m_segments.emplace_back(std::make_shared<std::vector<T>>(m_segmentSize));
-			}
-			++m_size;
-			(*this)[m_size - 1] = std::forward<U>(value);
-			return m_size - 1;
+			return emplace_back(std::forward<U>(value));
 		}
 
+		/// @brief Push a default constructed value to the back of the vector.
 		auto push_back() -> size_t override {
-			return push_back(T{});
+			if constexpr (std::is_default_constructible_v<T>) {
+				return emplace_back();
+			} else {
+				std::cout << "Type " << typeid(T).name() << " cannot be default constructed!" << std::endl;
+				assert(false);
+				exit(-1);
+			}
 		}
 
-		/// @brief Pop the last value from the vector.
+		/// @brief Pop the last value from the vector. One empty segment is kept as spare, so a size
+		/// oscillating around a segment boundary does not allocate and free a segment each time.
 		void pop_back() override {
 			assert(m_size > 0);
-			--m_size;
-			if (Offset(m_size) == 0 && m_segments.size() > 1) {
-				m_segments.pop_back();
-			}
+			std::destroy_at(&m_segments[Segment(m_size - 1)][Offset(m_size - 1)]);
+			RemoveLast();
 		}
 
 		/// @brief Get the value at an index.
 		/// @param index The index of the value.
 		auto operator[](size_t index) const -> T& {
 			assert(index < m_size);
-			auto seg = Segment(index);
-			auto off = Offset(index);
-			return (*m_segments[Segment(index)])[Offset(index)];
+			return m_segments[Segment(index)][Offset(index)];
 		}
 
 		/// @brief Get the value at an index.
 		auto size() const -> size_t override { return m_size; }
 
+		/// @brief Make sure that there are segments for a number of elements. The segments are allocated, but not written.
+		/// @param n Number of elements.
+		void reserve(size_t n) {
+			while (n > 0 && Segment(n - 1) >= m_segments.size()) {
+				m_segments.emplace_back(AllocateSegment());
+			}
+		}
+
+		/// @brief Get the number of elements that fit into the allocated segments.
+		auto capacity() const -> size_t override { return SegmentStart(m_segments.size()); }
+
 		/// @brief Clear the vector. Make sure that one segment is always available.
 		void clear() override {
+			Destroy(0, m_size);
+			size_t bytes = std::min(m_size, m_segmentSize) * sizeof(T);
 			m_size = 0;
-			m_segments.clear();
-			m_segments.emplace_back(std::make_shared<std::vector<T>>(m_segmentSize));
+			while (m_segments.size() > 1) { FreeLastSegment(); }
+			if (m_memory != SegmentMemory::Heap && !m_segments.empty()) { Decommit(m_segments[0], bytes); }
 		}
 
 		/// @brief Erase an entity from the vector.
 		auto erase(size_t index) -> size_t override {
 			size_t last = size() - 1;
 			assert(index <= last);
-			if (index < last) {
-				(*this)[index] = std::move((*this)[last]); //move the last entity to the erased one
+			if constexpr (is_trivially_relocatable_v<T>) {
+				if (index < last) {
+					std::destroy_at(&(*this)[index]);
+					Relocate(&(*this)[index], &(*this)[last], 1); //relocate the last entity to the erased one
+					RemoveLast();
+					return last;
+				}
+			} else {
+				if (index < last) {
+					(*this)[index] = std::move((*this)[last]); //move the last entity to the erased one
+				}
 			}
 			pop_back(); //erase the last entity
 			return last; //if index < last then last element was moved -> correct mapping 
@@ -147,14 +511,156 @@ namespace vecs {
 			push_back((static_cast<Vector<T>*>(other))->operator[](from));
 		}
 
+		/// @brief Move an entity from another vector of the same type to the back of this vector, and erase it from the
+		/// other vector like erase() does. Trivially relocatable types are moved with memcpy.
+		/// @param other The other vector.
+		/// @param from Index of the entity in the other vector.
+		/// @return The index of the last entity of the other vector, which was moved to index from if from is smaller.
+		auto relocate(VectorBase* other, size_t from) -> size_t override {
+			auto& src = *static_cast<Vector<T>*>(other);
+			size_t last = src.m_size - 1;
+			assert(from <= last);
+			if constexpr (is_trivially_relocatable_v<T>) {
+				reserve(m_size + 1);
+				Relocate(&m_segments[Segment(m_size)][Offset(m_size)], &src[from], 1);
+				++m_size;
+				if (from < last) { Relocate(&src[from], &src[last], 1); }
+				src.RemoveLast();
+				return last;
+			} else {
+				emplace_back(std::move(src[from]));
+				return src.erase(from);
+			}
+		}
+
+		/// @brief Append a range of entities from another vector of the same type to this.
+		/// Trivially copyable types are copied with memcpy, one run of contiguous elements at a time.
+		/// @param other The source vector.
+		/// @param first Index of the first entity in the source vector.
+		/// @param count Number of entities to append.
+		void append_range(VectorBase* other, size_t first, size_t count) override {
+			auto& src = *static_cast<Vector<T>*>(other);
+			assert(first + count <= src.m_size);
+			reserve(m_size + count);
+			while (count > 0) {
+				size_t n = std::min({ count, src.Run(first), Run(m_size) });
+				T* from = &src.m_segments[src.Segment(first)][src.Offset(first)];
+				T* to = &m_segments[Segment(m_size)][Offset(m_size)];
+				if constexpr (std::is_trivially_copyable_v<T>) { std::memcpy(to, from, n * sizeof(T)); }
+				else { std::uninitialized_copy_n(from, n, to); }
+				m_size += n;
+				first += n;
+				count -= n;
+			}
+		}
+
+		/// @brief Erase a range of entities. Like erase(), the hole is filled with the entities from the end of the vector.
+		/// @param first Index of the first entity to erase.
+		/// @param count Number of entities to erase.
+		/// @return Old index of the first entity that was moved into the hole. The entities from this index up to the old
+		/// size were moved to the indices starting at first. If nothing was moved, the return value is the old size.
+		auto erase_range(size_t first, size_t count) -> size_t override {
+			assert(first + count <= m_size);
+			size_t last = m_size;
+			size_t tail = std::max(first + count, last - count);
+			if constexpr (is_trivially_relocatable_v<T>) { Destroy(first, first + count); } //relocate into the erased slots
+			for (size_t from = tail, to = first; from < last; ) { //the ranges do not overlap
+				size_t n = std::min({ last - from, Run(from), Run(to) });
+				T* src = &m_segments[Segment(from)][Offset(from)];
+				T* dst = &m_segments[Segment(to)][Offset(to)];
+				if constexpr (is_trivially_relocatable_v<T>) { Relocate(dst, src, n); }
+				else { std::move(src, src + n, dst); }
+				from += n;
+				to += n;
+			}
+			if constexpr (!is_trivially_relocatable_v<T>) { Destroy(last - count, last); } //relocated slots are already dead
+			m_size = last - count;
+			Shrink();
+			return tail;
+		}
+
+		/// @brief Resize the vector. New entities are value initialized, superfluous entities are destroyed.
+		/// @param n The new size.
+		void resize(size_t n) override {
+			if (n <= m_size) {
+				Destroy(n, m_size);
+				m_size = n;
+				Shrink();
+				return;
+			}
+			if constexpr (std::is_default_constructible_v<T>) {
+				reserve(n);
+				while (m_size < n) {
+					size_t k = std::min(n - m_size, Run(m_size));
+					std::uninitialized_value_construct_n(&m_segments[Segment(m_size)][Offset(m_size)], k);
+					m_size += k;
+				}
+			} else {
+				std::cout << "Type " << typeid(T).name() << " cannot be default constructed!" << std::endl;
+				assert(false);
+				exit(-1);
+			}
+		}
+
+		/// @brief Append values to the end of the vector, one run of contiguous elements at a time.
+		/// @param values The values to append.
+		void append(std::span<const T> values) {
+			reserve(m_size + values.size());
+			for (size_t first = 0; first < values.size(); ) {
+				size_t n = std::min(values.size() - first, Run(m_size));
+				T* to = &m_segments[Segment(m_size)][Offset(m_size)];
+				if constexpr (std::is_trivially_copyable_v<T>) { std::memcpy(to, values.data() + first, n * sizeof(T)); }
+				else { std::uninitialized_copy_n(values.data() + first, n, to); }
+				m_size += n;
+				first += n;
+			}
+		}
+
+		/// @brief Assign a value to a range of entities.
+		/// @param first Index of the first entity.
+		/// @param count Number of entities.
+		/// @param value The value to assign.
+		void fill(size_t first, size_t count, const T& value) {
+			assert(first + count <= m_size);
+			while (count > 0) {
+				size_t n = std::min(count, Run(first));
+				std::fill_n(&m_segments[Segment(first)][Offset(first)], n, value);
+				first += n;
+				count -= n;
+			}
+		}
+
 		/// @brief Swap two entities in the vector.
 		void swap(size_t index1, size_t index2) override {
-			std::swap((*this)[index1], (*this)[index2]);
+			if constexpr (is_trivially_relocatable_v<T>) {
+				if (index1 == index2) { return; }
+				alignas(T) std::byte tmp[sizeof(T)];
+				Relocate(reinterpret_cast<T*>(tmp), &(*this)[index1], 1);
+				Relocate(&(*this)[index1], &(*this)[index2], 1);
+				Relocate(&(*this)[index2], reinterpret_cast<T*>(tmp), 1);
+			} else {
+				std::swap((*this)[index1], (*this)[index2]);
+			}
 		}
 
-		/// @brief Clone the vector.
+		/// @brief Clone the vector. The clone is empty, but has the same segment sizes and pool.
 		auto clone() -> std::unique_ptr<VectorBase> override {
-			return std::make_unique<Vector<T>>();
+			return std::make_unique<Vector<T>>(m_segmentBits, m_pool, m_firstBits, m_memory);
+		}
+
+		/// @brief Take the segments of this vector from a chunk store. The vector must be empty. Segments are then
+		/// allocated when elements are added, and all have the size of a chunk column.
+		/// @param store The chunk store.
+		/// @param column Index of this vector's column in the chunks.
+		void attach(ChunkStore* store, size_t column) override {
+			assert(m_size == 0 && alignof(T) <= SEGMENT_ALIGNMENT);
+			while (!m_segments.empty()) { FreeLastSegment(); }
+			m_segmentBits = m_firstBits = store->Bits();
+			m_segmentSize = 1ull << m_segmentBits;
+			m_geomLimit = 0;
+			m_memory = SegmentMemory::Heap;
+			m_store = store;
+			m_column = column;
 		}
 
 		/// @brief Print the vector.
@@ -165,22 +671,174 @@ namespace vecs {
 		auto begin() -> Iterator { return Iterator{ *this, 0 }; }
 		auto end() -> Iterator { return Iterator{ *this, m_size }; }
 
+		/// @brief Get the contiguous elements starting at an index, up to the end of its segment or the end of the vector.
+		/// @param index Index of the first element.
+		/// @return Span of contiguous elements.
+		auto Span(size_t index) const -> std::span<T> {
+			assert(index < m_size);
+			size_t count = std::min(Run(index), m_size - index);
+			return { &m_segments[Segment(index)][Offset(index)], count };
+		}
+
+		/// @brief Get the elements of the vector as a range of contiguous spans, one span per segment.
+		/// @return A view of spans.
+		auto Segments() const {
+			size_t number = m_size > 0 ? Segment(m_size - 1) + 1 : 0;
+			return std::views::iota(size_t{ 0 }, number) | std::views::transform([this](size_t segment) { return Span(SegmentStart(segment)); });
+		}
+
+		/// @brief Call a function for each contiguous span of elements. Inner loops over a span can be vectorized by the compiler.
+		/// @param fun Function that is called with a std::span<T>.
+		void ForEachSpan(auto&& fun) {
+			for (size_t index = 0; index < m_size; ) {
+				auto span = Span(index);
+				fun(span);
+				index += span.size();
+			}
+		}
+
 	private:
 
 		/// @brief Compute the segment index of an entity index.
 		/// @param index Entity index.
 		/// @return Index of the segment.
-		inline size_t Segment(size_t index) const { return index >> m_segmentBits; }
+		inline size_t Segment(size_t index) const { 
+			if (index >= m_geomLimit) [[likely]] { return (m_segmentBits - m_firstBits) + (index >> m_segmentBits); }
+			return std::bit_width(index >> m_firstBits);
+		}
 
 		/// @brief Compute the offset of an entity index in a segment.
 		/// @param index Entity index.
 		/// @return Offset in the segment.
-		inline size_t Offset(size_t index) const { return index & (m_segmentSize - 1ul); }
+		inline size_t Offset(size_t index) const { 
+			if (index >= m_geomLimit) [[likely]] { return index & (m_segmentSize - 1ul); }
+			size_t segment = std::bit_width(index >> m_firstBits);
+			return segment == 0 ? index : index & ((1ull << (m_firstBits + segment - 1)) - 1ul);
+		}
+
+		/// @brief Compute the index of the first entity in a segment.
+		/// @param segment Segment index.
+		/// @return Entity index.
+		inline size_t SegmentStart(size_t segment) const {
+			size_t geometric = m_segmentBits - m_firstBits; //number of growing segments after the first one
+			if (segment > geometric) { return (segment - geometric) << m_segmentBits; }
+			return segment == 0 ? 0 : 1ull << (m_firstBits + segment - 1);
+		}
+
+		/// @brief Compute the number of elements a segment holds.
+		/// @param segment Segment index.
+		/// @return Number of elements.
+		inline size_t SegmentCapacity(size_t segment) const { return SegmentStart(segment + 1) - SegmentStart(segment); }
+
+		/// @brief Number of contiguous element slots from an index to the end of its segment.
+		/// @param index Entity index.
+		/// @return Number of slots.
+		inline size_t Run(size_t index) const { return SegmentCapacity(Segment(index)) - Offset(index); }
+
+		/// @brief Remove the last element without destroying it, because it was relocated. Keeps a spare segment like pop_back().
+		void RemoveLast() {
+			--m_size;
+			if (Offset(m_size) == 0 && m_segments.size() > Segment(m_size) + 1) {
+				FreeLastSegment();
+			}
+		}
+
+		/// @brief Move elements to uninitialized memory with memcpy. Afterwards the source elements are dead and must not be destroyed.
+		/// @param dst Pointer to the uninitialized destination.
+		/// @param src Pointer to the source elements.
+		/// @param n Number of elements.
+		static void Relocate(T* dst, T* src, size_t n) {
+			std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+		}
+
+		/// @brief Free the segments behind the segment holding the next free slot, as pop_back() does at a segment boundary.
+		void Shrink() {
+			while (m_segments.size() > Segment(m_size) + 1) { FreeLastSegment(); }
+		}
+
+		/// @brief Alignment of the segments, at least a cache line.
+		static constexpr size_t Alignment() { return std::max(SEGMENT_ALIGNMENT, alignof(T)); }
+
+		/// @brief Test whether segments are taken from the pool. Over-aligned types bypass the pool.
+		bool UsePool() const { return m_pool != nullptr && Alignment() == SEGMENT_ALIGNMENT; }
+
+		/// @brief Allocate the next aligned segment. The memory is not initialized.
+		/// @return Pointer to the first element of the segment.
+		auto AllocateSegment() -> Segment_t {
+			if (m_store) { return static_cast<Segment_t>(m_store->Acquire(m_segments.size(), m_column)); }
+			size_t bytes = SegmentCapacity(m_segments.size()) * sizeof(T);
+			if (m_memory != SegmentMemory::Heap) { return static_cast<Segment_t>(MapRange(bytes)); }
+			return static_cast<Segment_t>(UsePool() ? m_pool->Allocate(bytes) : ::operator new(bytes, std::align_val_t{ Alignment() }));
+		}
+
+		/// @brief Free the memory of the last segment and remove it from the segment table. The segment must not contain live elements.
+		void FreeLastSegment() {
+			Segment_t segment = m_segments.back();
+			m_segments.pop_back();
+			if (m_store) { m_store->Release(m_segments.size()); }
+			else if (m_memory != SegmentMemory::Heap) { UnmapRange(segment, SegmentCapacity(m_segments.size()) * sizeof(T)); }
+			else if (UsePool()) { m_pool->Deallocate(segment, SegmentCapacity(m_segments.size()) * sizeof(T)); }
+			else { ::operator delete(segment, std::align_val_t{ Alignment() }); }
+		}
+
+		/// @brief Reserve a range of virtual memory. Pages are committed by the system when they are touched first.
+		/// Only used if MAPPED_MEMORY is true.
+		/// @param bytes Size of the range in bytes.
+		/// @return Pointer to the range.
+		auto MapRange(size_t bytes) -> void* {
+#if defined(__linux__)
+			void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (memory == MAP_FAILED) {
+				std::cout << "Could not map " << bytes << " bytes for a segment!" << std::endl;
+				assert(false);
+				exit(-1);
+			}
+			if (m_memory == SegmentMemory::MappedHugePages) { madvise(memory, bytes, MADV_HUGEPAGE); } //only a hint
+			return memory;
+#else
+			assert(false);
+			return nullptr;
+#endif
+		}
+
+		/// @brief Release a range of virtual memory reserved by MapRange().
+		/// @param memory Pointer to the range.
+		/// @param bytes Size of the range in bytes.
+		void UnmapRange(void* memory, size_t bytes) {
+#if defined(__linux__)
+			munmap(memory, bytes);
+#endif
+		}
+
+		/// @brief Give the committed pages of a mapped range back to the system. The range stays reserved.
+		/// @param memory Pointer to the range.
+		/// @param bytes Number of bytes that might have been touched.
+		void Decommit(void* memory, size_t bytes) {
+#if defined(__linux__)
+			static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+			madvise(memory, (bytes + page - 1) & ~(page - 1), MADV_DONTNEED);
+#endif
+		}
+
+		/// @brief Destroy the elements in an index range.
+		/// @param first Index of the first element.
+		/// @param last Index one past the last element.
+		void Destroy(size_t first, size_t last) {
+			if constexpr (!std::is_trivially_destructible_v<T>) {
+				for (size_t i = first; i < last; ++i) { std::destroy_at(&m_segments[Segment(i)][Offset(i)]); }
+			}
+		}
 
 		size_t m_size{ 0 };	///< Size of the vector.
 		size_t m_segmentBits;	///< Number of bits for the segment size.
 		size_t m_segmentSize; ///< Size of a segment.
-		Vector_t m_segments{ 10 };	///< Vector holding unique pointers to the segments.
+		size_t m_firstBits;	///< Number of bits for the size of the first segment, equals m_segmentBits if all segments have the same size.
+		size_t m_geomLimit{ 0 };	///< Entities below this index are in growing segments, 0 if all segments have the same size.
+		SegmentPool* m_pool{ nullptr }; ///< Pool for recycling segments, nullptr means system allocator.
+		SegmentMemory m_memory{ SegmentMemory::Heap }; ///< Memory backend of the segments.
+		ChunkStore* m_store{ nullptr }; ///< Chunk store providing the segments, nullptr if the vector allocates its own segments.
+		size_t m_column{ 0 }; ///< Index of the column in the chunks of the chunk store.
+		Vector_t m_segments{};	///< Segment table holding pointers to the segments.
 
 
 		//Methods for Console communication
@@ -201,9 +859,15 @@ namespace vecs {
 		/// @brief get the Type hash for the Vector's elements.
 		/// @return Type hash.
 		virtual size_t GetType() override { return Type<T>(); }
+		/// @brief get the dense type ID of the Vector's elements.
+		/// @return Type ID.
+		size_t GetTypeId() override { return TypeId<T>(); }
 		/// @brief get the base size of an element in the Vector.
 		/// @return base element size; if the element allocates further data, this is not accounted for.
 		size_t ElemSize() override { return sizeof(T); }
+		/// @brief get the alignment of an element in the Vector.
+		/// @return element alignment.
+		size_t ElemAlign() override { return alignof(T); }
 
 	}; //end of Vector
 
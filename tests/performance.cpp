@@ -11,11 +11,48 @@
 #include <functional>
 #include <numeric>
 #include <vector>
+#include <array>
+#include <thread>
+#include <mutex>
 
 #include "VECS.h"
 
+/// @brief Segmented vector with the previous storage layout, each segment is a std::shared_ptr<std::vector<T>>.
+/// Used as a baseline to compare against vecs::Vector.
 template<typename T>
-void refill_containers(size_t size, std::vector<vecs::Vector<T>> & containers) {
+class SharedSegmentVector {
+public:
+	SharedSegmentVector(size_t segmentBits = 6) : m_segmentBits{segmentBits}, m_segmentSize{1ull << segmentBits} {
+		m_segments.emplace_back(std::make_shared<std::vector<T>>(m_segmentSize));
+	}
+
+	void push_back(T&& value) {
+		while ((m_size >> m_segmentBits) >= m_segments.size()) {
+			m_segments.emplace_back(std::make_shared<std::vector<T>>(m_segmentSize));
+		}
+		++m_size;
+		(*this)[m_size - 1] = std::move(value);
+	}
+
+	auto operator[](size_t index) const -> T& {
+		return (*m_segments[index >> m_segmentBits])[index & (m_segmentSize - 1)];
+	}
+
+	void clear() {
+		m_size = 0;
+		m_segments.clear();
+		m_segments.emplace_back(std::make_shared<std::vector<T>>(m_segmentSize));
+	}
+
+private:
+	size_t m_size{0};
+	size_t m_segmentBits;
+	size_t m_segmentSize;
+	std::vector<std::shared_ptr<std::vector<T>>> m_segments;
+};
+
+template<typename T, template<typename> class C>
+void refill_containers(size_t size, std::vector<C<T>> & containers) {
     std::random_device rd;  // Hardware-based random seed
 	std::mt19937 gen(rd()); // Mersenne Twister generator   
 
@@ -39,37 +76,42 @@ void refill_containers(size_t size, std::vector<vecs::Vector<T>> & containers) {
 	}
 }
 
-template<typename T>
-auto p1(size_t components, size_t size, std::vector<vecs::Vector<T>> & containers, bool seq = true) {
+template<typename T, template<typename> class C>
+auto p1(size_t components, size_t size, std::vector<C<T>> & containers, bool seq = true) {
 	volatile size_t sum = 0;
 	volatile size_t index = 0;
 	for( size_t i = 0; i < size; i++) {
 		if( components > 1 ) index = i;
 		for( size_t j = 0; j < components; j++) {			
 			volatile size_t value = containers[j][index].value;
-			sum += value;
+			sum = sum + value;
 			index = seq ? i : value;
 		}
 	}
 	return sum;
 }
 
+template<typename data, template<typename> class C>
+auto make_containers(size_t bits) {
+	std::vector<C<data>> containers;
+	for( size_t i = 0; i < 15; ++i ) { containers.emplace_back(bits); }
+	return containers;
+}
+
 template<typename data>
 void run() {
 	size_t max_size = 102400;
 	size_t repetitions = 100;
 
 	constexpr size_t BITS = 10ul;
-	std::vector<vecs::Vector<data>> containers {
-		vecs::Vector<data>(BITS), vecs::Vector<data>(BITS), vecs::Vector<data>(BITS), vecs::Vector<data>(BITS), vecs::Vector<data>(BITS),
-		vecs::Vector<data>(BITS), vecs::Vector<data>(BITS), vecs::Vector<data>(BITS), vecs::Vector<data>(BITS), vecs::Vector<data>(BITS),
-		vecs::Vector<data>(BITS), vecs::Vector<data>(BITS), vecs::Vector<data>(BITS), vecs::Vector<data>(BITS), vecs::Vector<data>(BITS)
-	};
+	auto containers = make_containers<data, vecs::Vector>(BITS);
+	auto shared = make_containers<data, SharedSegmentVector>(BITS); //previous layout as baseline
 
 	std::cout << "subgroup,dataset,x,y" << std::endl;
 	volatile size_t sum = 0;
 
 	refill_containers(max_size, containers);
+	refill_containers(max_size, shared);
 
 	for( size_t size = 1024; size <= max_size;  ) {
 	
@@ -79,16 +121,23 @@ void run() {
 
 			for( size_t components = 1; components<=10; ) {
 				refill_containers(size, containers);
+				refill_containers(size, shared);
 
 				auto t1 = std::chrono::high_resolution_clock::now();
-				sum += p1(components, size, containers, true);
+				sum = sum + p1(components, size, containers, true);
 				auto t2 = std::chrono::high_resolution_clock::now();
-				sum += p1(components, size, containers, false);
+				sum = sum + p1(components, size, containers, false);
 				auto t3 = std::chrono::high_resolution_clock::now();
+				sum = sum + p1(components, size, shared, true);
+				auto t4 = std::chrono::high_resolution_clock::now();
+				sum = sum + p1(components, size, shared, false);
+				auto t5 = std::chrono::high_resolution_clock::now();
 
 				if( rep>=20 ) {
 					std::cout << "Seq," << std::setw(2) << components << "C," << size << "," << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()/1000.0 << std::endl;
 					std::cout << "Rnd," << std::setw(2) << components << "C," << size << "," << std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count()/1000.0 << std::endl;
+					std::cout << "SeqShared," << std::setw(2) << components << "C," << size << "," << std::chrono::duration_cast<std::chrono::nanoseconds>(t4 - t3).count()/1000.0 << std::endl;
+					std::cout << "RndShared," << std::setw(2) << components << "C," << size << "," << std::chrono::duration_cast<std::chrono::nanoseconds>(t5 - t4).count()/1000.0 << std::endl;
 				}
 
 				components+=cdelta;
@@ -99,6 +148,454 @@ void run() {
 	}
 }
 
+struct pos_t { float x, y, z; };
+struct vel_t { float x, y, z; };
+
+/// @brief Compare element-wise and span-wise iteration for a pos += vel * dt kernel,
+/// both on plain vectors and on a registry view.
+void run_spans() {
+	size_t max_size = 1024*1024;
+	size_t repetitions = 20;
+	const float dt = 0.016f;
+
+	std::cout << "subgroup,dataset,x,y" << std::endl;
+	for( size_t size = 1024; size <= max_size; size *= 4 ) {
+		vecs::Vector<pos_t> pos;
+		vecs::Vector<vel_t> vel;
+		vecs::Registry system;
+		for( size_t i = 0; i < size; ++i ) {
+			pos.push_back( pos_t{(float)i, 0.0f, 0.0f} );
+			vel.push_back( vel_t{1.0f, 2.0f, 3.0f} );
+			[[maybe_unused]] auto handle = system.Insert( pos_t{(float)i, 0.0f, 0.0f}, vel_t{1.0f, 2.0f, 3.0f} );
+		}
+
+		for( size_t rep = 1; rep <= repetitions; ++rep ) {
+			auto t1 = std::chrono::high_resolution_clock::now();
+			for( size_t i = 0; i < size; ++i ) {
+				auto& p = pos[i];
+				auto& v = vel[i];
+				p.x += v.x * dt; p.y += v.y * dt; p.z += v.z * dt;
+			}
+			auto t2 = std::chrono::high_resolution_clock::now();
+			for( size_t i = 0; i < size; ) { //pos and vel have the same segment size
+				auto ps = pos.Span(i);
+				auto vs = vel.Span(i);
+				for( size_t k = 0; k < ps.size(); ++k ) {
+					ps[k].x += vs[k].x * dt; ps[k].y += vs[k].y * dt; ps[k].z += vs[k].z * dt;
+				}
+				i += ps.size();
+			}
+			auto t3 = std::chrono::high_resolution_clock::now();
+			for( auto [p, v] : system.template GetView<pos_t&, vel_t>() ) {
+				auto& pr = p();
+				pr.x += v.x * dt; pr.y += v.y * dt; pr.z += v.z * dt;
+			}
+			auto t4 = std::chrono::high_resolution_clock::now();
+			system.template GetView<pos_t, vel_t>().ForEachSpan( [&](std::span<pos_t> ps, std::span<vel_t> vs) {
+				for( size_t k = 0; k < ps.size(); ++k ) {
+					ps[k].x += vs[k].x * dt; ps[k].y += vs[k].y * dt; ps[k].z += vs[k].z * dt;
+				}
+			});
+			auto t5 = std::chrono::high_resolution_clock::now();
+
+			if( rep >= 5 ) {
+				std::cout << "VectorElem,pos+=vel*dt," << size << "," << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()/1000.0 << std::endl;
+				std::cout << "VectorSpan,pos+=vel*dt," << size << "," << std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count()/1000.0 << std::endl;
+				std::cout << "ViewElem,pos+=vel*dt," << size << "," << std::chrono::duration_cast<std::chrono::nanoseconds>(t4 - t3).count()/1000.0 << std::endl;
+				std::cout << "ViewSpan,pos+=vel*dt," << size << "," << std::chrono::duration_cast<std::chrono::nanoseconds>(t5 - t4).count()/1000.0 << std::endl;
+			}
+		}
+	}
+}
+
+/// @brief Compare copying rows between vectors one virtual call per entity with a single append_range() call.
+template<typename data>
+void run_bulk() {
+	size_t max_size = 1024*1024;
+	size_t repetitions = 20;
+
+	std::cout << "subgroup,dataset,x,y" << std::endl;
+	for( size_t size = 1024; size <= max_size; size *= 4 ) {
+		vecs::Vector<data> src;
+		for( size_t i = 0; i < size; ++i ) { src.push_back( data{.value = i, .pad = {}} ); }
+		std::unique_ptr<vecs::VectorBase> dst = src.clone();
+
+		for( size_t rep = 1; rep <= repetitions; ++rep ) {
+			dst->clear();
+			auto t1 = std::chrono::high_resolution_clock::now();
+			for( size_t i = 0; i < size; ++i ) { dst->copy( &src, i ); }
+			auto t2 = std::chrono::high_resolution_clock::now();
+			dst->clear();
+			auto t3 = std::chrono::high_resolution_clock::now();
+			dst->append_range( &src, 0, size );
+			auto t4 = std::chrono::high_resolution_clock::now();
+
+			if( rep >= 5 ) {
+				std::cout << "CopyElem,copy," << size << "," << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()/1000.0 << std::endl;
+				std::cout << "CopyRange,copy," << size << "," << std::chrono::duration_cast<std::chrono::nanoseconds>(t4 - t3).count()/1000.0 << std::endl;
+			}
+		}
+	}
+}
+
+struct palette_t { float m[16][32]; }; //2 KB component
+
+/// @brief Columns of one archetype, created with the given segment bits.
+struct columns_t {
+	vecs::Vector<size_t> handles;
+	vecs::Vector<int> ints;
+	vecs::Vector<palette_t> palettes;
+	columns_t(size_t b8, size_t f8, size_t b4, size_t f4, size_t b2k, size_t f2k) 
+		: handles{b8, nullptr, f8}, ints{b4, nullptr, f4}, palettes{b2k, nullptr, f2k} {}
+	auto Bytes() -> size_t {
+		return handles.capacity()*sizeof(size_t) + ints.capacity()*sizeof(int) + palettes.capacity()*sizeof(palette_t);
+	}
+};
+
+/// @brief Compare memory per entity and iteration time of a fixed segment size of 64 elements,
+/// segment sizes by bytes, and segment sizes by bytes with geometric growth.
+void run_segments() {
+	size_t num_archetypes = 64;
+	size_t repetitions = 20;
+	using vecs::SegmentBits;
+	constexpr size_t B = vecs::SEGMENT_BYTES;
+	constexpr size_t F = vecs::SEGMENT_FIRST_BYTES;
+
+	std::cout << "subgroup,dataset,x,y" << std::endl;
+	for( size_t size = 1; size <= 4096; size *= 4 ) { //entities per archetype
+		for( int mode = 0; mode < 3; ++mode ) {
+			std::vector<columns_t> archetypes;
+			for( size_t a = 0; a < num_archetypes; ++a ) {
+				if( mode == 0 ) archetypes.emplace_back( 6, 0, 6, 0, 6, 0 );
+				if( mode == 1 ) archetypes.emplace_back( SegmentBits<size_t>(B), 0, SegmentBits<int>(B), 0, SegmentBits<palette_t>(B), 0 );
+				if( mode == 2 ) archetypes.emplace_back( SegmentBits<size_t>(B), SegmentBits<size_t>(F), SegmentBits<int>(B), SegmentBits<int>(F), SegmentBits<palette_t>(B), SegmentBits<palette_t>(F) );
+				for( size_t i = 0; i < size; ++i ) {
+					archetypes.back().handles.push_back( i );
+					archetypes.back().ints.push_back( (int)i );
+					archetypes.back().palettes.push_back( palette_t{} );
+				}
+			}
+			size_t bytes = 0;
+			for( auto& arch : archetypes ) { bytes += arch.Bytes(); }
+
+			const char* name = mode == 0 ? "Fixed64" : (mode == 1 ? "Bytes" : "BytesGeometric");
+			volatile float sum = 0;
+			for( size_t rep = 1; rep <= repetitions; ++rep ) {
+				auto t1 = std::chrono::high_resolution_clock::now();
+				float s = 0;
+				for( auto& arch : archetypes ) {
+					arch.handles.ForEachSpan( [&](std::span<size_t> span){ for( auto& v : span ) { s += (float)v; } } );
+					arch.ints.ForEachSpan( [&](std::span<int> span){ for( auto& v : span ) { s += (float)v; } } );
+					arch.palettes.ForEachSpan( [&](std::span<palette_t> span){ for( auto& v : span ) { s += v.m[0][0]; } } );
+				}
+				sum = sum + s;
+				auto t2 = std::chrono::high_resolution_clock::now();
+				if( rep >= 5 ) {
+					std::cout << name << ",time," << size << "," << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()/1000.0 << std::endl;
+				}
+			}
+			std::cout << name << ",bytes/entity," << size << "," << (double)bytes / (double)(size*num_archetypes) << std::endl;
+		}
+	}
+}
+
+struct anim_t { float m_bones[64]; }; //256 bytes, trivially relocatable
+struct anim_nt { //256 bytes, user provided copy and move, thus not trivially relocatable
+	float m_bones[64];
+	anim_nt() = default;
+	anim_nt(const anim_nt& other) { std::copy_n(other.m_bones, 64, m_bones); }
+	anim_nt& operator=(const anim_nt& other) { std::copy_n(other.m_bones, 64, m_bones); return *this; }
+};
+
+/// @brief Move entities with a large component to another archetype by adding a tag, then erase them in random order.
+template<typename A>
+auto erase_entities(size_t size, std::mt19937& gen) {
+	vecs::Registry system;
+	std::vector<vecs::Handle> handles;
+	for( size_t i = 0; i < size; ++i ) { handles.push_back( system.Insert( A{}, (int)i ) ); }
+	std::ranges::shuffle(handles, gen);
+	auto t1 = std::chrono::high_resolution_clock::now();
+	for( auto handle : handles ) { system.AddTags( handle, 1ul ); }
+	auto t2 = std::chrono::high_resolution_clock::now();
+	for( auto handle : handles ) { system.Erase( handle ); }
+	auto t3 = std::chrono::high_resolution_clock::now();
+	return std::make_pair( std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()/1000.0, std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count()/1000.0 );
+}
+
+/// @brief Compare archetype moves and erasures of trivially relocatable and not relocatable components.
+void run_erase() {
+	size_t repetitions = 10;
+	std::mt19937 gen(42);
+
+	std::cout << "subgroup,dataset,x,y" << std::endl;
+	for( size_t size = 1024; size <= 256*1024; size *= 4 ) {
+		for( size_t rep = 1; rep <= repetitions; ++rep ) {
+			auto [moveR, eraseR] = erase_entities<anim_t>(size, gen);
+			auto [moveN, eraseN] = erase_entities<anim_nt>(size, gen);
+			if( rep >= 3 ) {
+				std::cout << "Relocatable,move," << size << "," << moveR << std::endl;
+				std::cout << "Relocatable,erase," << size << "," << eraseR << std::endl;
+				std::cout << "NotRelocatable,move," << size << "," << moveN << std::endl;
+				std::cout << "NotRelocatable,erase," << size << "," << eraseN << std::endl;
+			}
+		}
+	}
+}
+
+/// @brief Insert entities, iterate over them and move them to another archetype, in a registry with the given chunk size.
+auto chunk_workload(size_t size, size_t chunkBytes) {
+	const float dt = 0.016f;
+	vecs::Registry system{chunkBytes};
+	std::vector<vecs::Handle> handles;
+	auto t1 = std::chrono::high_resolution_clock::now();
+	for( size_t i = 0; i < size; ++i ) { 
+		handles.push_back( system.Insert( pos_t{(float)i, 0.0f, 0.0f}, vel_t{1.0f, 2.0f, 3.0f}, (int)i, (double)i ) ); 
+	}
+	auto t2 = std::chrono::high_resolution_clock::now();
+	for( auto [p, v, i] : system.template GetView<pos_t&, vel_t, int>() ) {
+		auto& pr = p();
+		pr.x += v.x * dt; pr.y += v.y * dt; pr.z += v.z * dt + i;
+	}
+	auto t3 = std::chrono::high_resolution_clock::now();
+	system.template GetView<pos_t, vel_t>().ForEachSpan( [&](std::span<pos_t> ps, std::span<vel_t> vs) {
+		for( size_t k = 0; k < ps.size(); ++k ) {
+			ps[k].x += vs[k].x * dt; ps[k].y += vs[k].y * dt; ps[k].z += vs[k].z * dt;
+		}
+	});
+	auto t4 = std::chrono::high_resolution_clock::now();
+	for( auto handle : handles ) { system.AddTags( handle, 1ul ); }
+	auto t5 = std::chrono::high_resolution_clock::now();
+	auto us = [](auto a, auto b) { return std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()/1000.0; };
+	return std::array<double, 4>{ us(t1, t2), us(t2, t3), us(t3, t4), us(t4, t5) };
+}
+
+/// @brief Compare the per-column Vector layout with the chunked archetype layout.
+void run_chunks() {
+	size_t repetitions = 10;
+	const char* names[] = { "insert", "iterate", "spans", "move" };
+
+	std::cout << "subgroup,dataset,x,y" << std::endl;
+	for( size_t size = 1024; size <= 256*1024; size *= 4 ) {
+		for( size_t rep = 1; rep <= repetitions; ++rep ) {
+			auto columns = chunk_workload(size, 0);
+			auto chunks = chunk_workload(size, vecs::CHUNK_BYTES);
+			if( rep >= 3 ) {
+				for( size_t i = 0; i < 4; ++i ) {
+					std::cout << "Columns," << names[i] << "," << size << "," << columns[i] << std::endl;
+					std::cout << "Chunks," << names[i] << "," << size << "," << chunks[i] << std::endl;
+				}
+			}
+		}
+	}
+}
+
+/// @brief Fill a vector and iterate over it with random accesses, for a given segment memory backend.
+template<typename T>
+auto mapped_workload(size_t size, vecs::Vector<T>& vec, std::vector<size_t>& indices) {
+	auto t1 = std::chrono::high_resolution_clock::now();
+	for( size_t i = 0; i < size; ++i ) { vec.push_back( T{.value = i, .pad = {}} ); }
+	auto t2 = std::chrono::high_resolution_clock::now();
+	[[maybe_unused]] volatile size_t sum = 0;
+	size_t s = 0;
+	for( auto i : indices ) { s += vec[i].value; }
+	sum = s;
+	auto t3 = std::chrono::high_resolution_clock::now();
+	auto us = [](auto a, auto b) { return std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()/1000.0; };
+	return std::make_pair( us(t1, t2), us(t2, t3) );
+}
+
+/// @brief Compare heap segments with one mapped segment, with and without huge pages.
+template<typename data>
+void run_mapped() {
+	size_t repetitions = 5;
+	std::mt19937 gen(42);
+	const char* names[] = { "Heap", "Mapped", "MappedHuge" };
+	vecs::SegmentMemory memories[] = { vecs::SegmentMemory::Heap, vecs::SegmentMemory::Mapped, vecs::SegmentMemory::MappedHugePages };
+
+	std::cout << "subgroup,dataset,x,y" << std::endl;
+	for( size_t size = 1ull << 16; size <= 1ull << 24; size <<= 2 ) {
+		std::vector<size_t> indices(size);
+		std::iota(indices.begin(), indices.end(), 0);
+		std::ranges::shuffle(indices, gen);
+		for( size_t rep = 1; rep <= repetitions; ++rep ) {
+			for( size_t m = 0; m < 3; ++m ) {
+				size_t bits = m == 0 ? vecs::SegmentBits<data>(vecs::SEGMENT_BYTES) : vecs::SegmentBits<data>(vecs::MAPPED_BYTES);
+				vecs::Vector<data> vec(bits, nullptr, 0, memories[m]);
+				auto [fill, random] = mapped_workload(size, vec, indices);
+				if( rep >= 2 ) {
+					std::cout << names[m] << ",fill," << size << "," << fill << std::endl;
+					std::cout << names[m] << ",random," << size << "," << random << std::endl;
+				}
+			}
+		}
+	}
+}
+
+/// @brief Slot with the previous array of structures layout, used as a baseline for version checks.
+struct aos_slot_t {
+	int64_t m_nextFree;
+	size_t m_version;
+	vecs::Archetype::ArchetypeAndIndex m_value;
+};
+
+/// @brief Random access Get and Exists over many handles. Compares version checks on the previous
+/// array of structures slots against the registry, which only reads 4 byte versions. Both use segments of the same byte size.
+void run_get() {
+	size_t size = 10'000'000;
+	size_t repetitions = 5;
+	std::mt19937 gen(42);
+	vecs::Registry system;
+	std::vector<vecs::Handle> handles;
+	handles.reserve(size);
+	for( size_t i = 0; i < size; ++i ) { handles.push_back( system.Insert((int)i, (float)i) ); }
+	vecs::Vector<aos_slot_t> aos(vecs::SegmentBits<aos_slot_t>(vecs::SEGMENT_BYTES));
+	for( auto& h : handles ) { aos.push_back( aos_slot_t{ -1, h.GetVersion(), {} } ); }
+	std::ranges::shuffle(handles, gen);
+	std::vector<uint8_t> result(size);
+
+	auto us = [](auto a, auto b) { return std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()/1000.0; };
+	std::cout << "subgroup,dataset,x,y" << std::endl;
+	for( size_t rep = 1; rep <= repetitions; ++rep ) {
+		[[maybe_unused]] volatile size_t sink = 0;
+		size_t s = 0;
+		auto t1 = std::chrono::high_resolution_clock::now();
+		for( auto& h : handles ) { s += aos[h.GetIndex()].m_version == h.GetVersion(); }
+		auto t2 = std::chrono::high_resolution_clock::now();
+		for( auto& h : handles ) { s += system.Exists(h); }
+		auto t3 = std::chrono::high_resolution_clock::now();
+		s += system.Exists(handles, result);
+		auto t4 = std::chrono::high_resolution_clock::now();
+		for( auto& h : handles ) { s += system.Get<int>(h); }
+		auto t5 = std::chrono::high_resolution_clock::now();
+		sink = s;
+		if( rep >= 2 ) {
+			std::cout << "AoS,exists," << size << "," << us(t1, t2) << std::endl;
+			std::cout << "SoA,exists," << size << "," << us(t2, t3) << std::endl;
+			std::cout << "SoA,batch," << size << "," << us(t3, t4) << std::endl;
+			std::cout << "SoA,get," << size << "," << us(t4, t5) << std::endl;
+		}
+	}
+}
+
+/// @brief Insert and erase entries of a slot map from several threads.
+template<typename F>
+auto slotmap_workload(size_t threads, size_t count, F&& churn) {
+	auto t1 = std::chrono::high_resolution_clock::now();
+	std::vector<std::thread> workers;
+	for( size_t t = 0; t < threads; ++t ) { workers.emplace_back( [&, count]() { churn(count); } ); }
+	for( auto& worker : workers ) { worker.join(); }
+	auto t2 = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()/1000.0;
+}
+
+/// @brief Compare a slot map guarded by a mutex with the lock free concurrent slot map. 
+/// Each thread inserts and erases the same number of entries.
+void run_slotmap() {
+	size_t repetitions = 5;
+	size_t count = 1 << 16;
+	std::cout << "subgroup,dataset,x,y" << std::endl;
+	for( size_t threads = 1; threads <= 32; threads <<= 1 ) {
+		for( size_t rep = 1; rep <= repetitions; ++rep ) {
+			vecs::SlotMap<size_t> locked(0, 20);
+			std::mutex mutex;
+			auto t1 = slotmap_workload(threads, count, [&](size_t n) {
+				std::vector<vecs::Handle> handles;
+				for( size_t round = 0; round < 4; ++round ) {
+					for( size_t i = 0; i < n / 4; ++i ) { std::lock_guard lock(mutex); handles.push_back( locked.Insert(i).first ); }
+					for( auto& h : handles ) { std::lock_guard lock(mutex); locked.Erase(h); }
+					handles.clear();
+				}
+			});
+
+			vecs::ConcurrentSlotMap<size_t> concurrent(0, 20);
+			auto t2 = slotmap_workload(threads, count, [&](size_t n) {
+				std::vector<vecs::Handle> handles;
+				for( size_t round = 0; round < 4; ++round ) {
+					for( size_t i = 0; i < n / 4; ++i ) { handles.push_back( concurrent.Insert(i).first ); }
+					for( auto& h : handles ) { concurrent.Erase(h); }
+					handles.clear();
+				}
+			});
+
+			if( rep >= 2 ) {
+				std::cout << "Mutex,churn," << threads << "," << t1 << std::endl;
+				std::cout << "LockFree,churn," << threads << "," << t2 << std::endl;
+			}
+		}
+	}
+}
+
+/// @brief Insert and erase from 1 to 32 threads into 16 shards. Compares threads that round robin over all shards 
+/// for each insert with threads that insert into their home shard.
+void run_shards() {
+	using Shards = vecs::SlotMapShards<vecs::ConcurrentSlotMap<size_t>>;
+	size_t repetitions = 5;
+	size_t count = 1 << 16;
+	std::cout << "subgroup,dataset,x,y" << std::endl;
+	for( size_t threads = 1; threads <= 32; threads <<= 1 ) {
+		for( size_t rep = 1; rep <= repetitions; ++rep ) {
+			Shards roundRobin(16, 16);
+			auto t1 = slotmap_workload(threads, count, [&](size_t n) {
+				std::vector<vecs::Handle> handles;
+				size_t shard = 0;
+				for( size_t round = 0; round < 4; ++round ) {
+					for( size_t i = 0; i < n / 4; ++i ) { handles.push_back( roundRobin.InsertAt(++shard, i).first ); }
+					for( auto& h : handles ) { roundRobin.Erase(h); }
+					handles.clear();
+				}
+			});
+
+			Shards home(16, 16);
+			auto t2 = slotmap_workload(threads, count, [&](size_t n) {
+				std::vector<vecs::Handle> handles;
+				for( size_t round = 0; round < 4; ++round ) {
+					for( size_t i = 0; i < n / 4; ++i ) { handles.push_back( home.Insert(i).first ); }
+					for( auto& h : handles ) { home.Erase(h); }
+					handles.clear();
+				}
+			});
+
+			if( rep >= 2 ) {
+				std::cout << "RoundRobin,churn," << threads << "," << t1 << std::endl;
+				std::cout << "HomeShard,churn," << threads << "," << t2 << std::endl;
+			}
+		}
+	}
+}
+
+/// @brief Create and erase entities one by one and in bulk.
+void run_spawn() {
+	size_t repetitions = 5;
+	auto us = [](auto a, auto b) { return std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()/1000.0; };
+	std::cout << "subgroup,dataset,x,y" << std::endl;
+	for( size_t size = 1 << 10; size <= 1 << 20; size <<= 2 ) {
+		for( size_t rep = 1; rep <= repetitions; ++rep ) {
+			vecs::Registry single;
+			std::vector<vecs::Handle> handles;
+			handles.reserve(size);
+			auto t1 = std::chrono::high_resolution_clock::now();
+			for( size_t i = 0; i < size; ++i ) { handles.push_back( single.Insert(pos_t{(float)i, 0.0f, 0.0f}, vel_t{1.0f, 0.0f, 0.0f}) ); }
+			auto t2 = std::chrono::high_resolution_clock::now();
+			for( auto& h : handles ) { single.Erase(h); }
+			auto t3 = std::chrono::high_resolution_clock::now();
+
+			vecs::Registry bulk;
+			auto t4 = std::chrono::high_resolution_clock::now();
+			auto bulkHandles = bulk.InsertBulk<pos_t, vel_t>( size, [](size_t i){ return std::make_tuple(pos_t{(float)i, 0.0f, 0.0f}, vel_t{1.0f, 0.0f, 0.0f}); } );
+			auto t5 = std::chrono::high_resolution_clock::now();
+			bulk.EraseBulk(bulkHandles);
+			auto t6 = std::chrono::high_resolution_clock::now();
+
+			if( rep >= 2 ) {
+				std::cout << "Single,insert," << size << "," << us(t1, t2) << std::endl;
+				std::cout << "Bulk,insert," << size << "," << us(t4, t5) << std::endl;
+				std::cout << "Single,erase," << size << "," << us(t2, t3) << std::endl;
+				std::cout << "Bulk,erase," << size << "," << us(t5, t6) << std::endl;
+			}
+		}
+	}
+}
+
 int main(int argc, char** argv) {
 	struct data8 {
 		size_t value;
@@ -112,6 +609,18 @@ int main(int argc, char** argv) {
 		size_t pad[7];
 	};
 
+	std::string mode = argc > 1 ? argv[1] : "vector";
+	if( mode == "spans" ) { run_spans(); return 0; }
+	if( mode == "bulk" ) { run_bulk<data32>(); return 0; }
+	if( mode == "segments" ) { run_segments(); return 0; }
+	if( mode == "erase" ) { run_erase(); return 0; }
+	if( mode == "chunks" ) { run_chunks(); return 0; }
+	if( mode == "mapped" ) { run_mapped<data32>(); return 0; }
+	if( mode == "get" ) { run_get(); return 0; }
+	if( mode == "slotmap" ) { run_slotmap(); return 0; }
+	if( mode == "shards" ) { run_shards(); return 0; }
+	if( mode == "spawn" ) { run_spawn(); return 0; }
+
 	run<data8>();
 	//run<data32>();
 	return 0;
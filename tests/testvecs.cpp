@@ -5,6 +5,8 @@
 #include <random>
 #include <iostream>
 #include <string>
+#include <array>
+#include <thread>
 
 #include "VECS.h"
 
@@ -39,10 +41,70 @@ void test_handle() {
 		check( h1 != h3 );
 		check( h2 != h3 );
 	}
+	{
+		using Small = vecs::HandleT<20,10,2>; //compact and wide handles are packed with constexpr shifts
+		using Wide = vecs::HandleT<40,16,8>;
+		static_assert( sizeof(Small) == 4 && sizeof(Wide) == 8 && sizeof(vecs::Handle) == 8 );
+		static_assert( Small{5, 1023, 3}.GetVersion() == 1023 && Small{5, 1024, 3}.GetVersion() == 0 && Small{5, 1, 3}.GetStorageIndex() == 3 );
+		constexpr Wide w{ (1ull << 39) + 7, 9, 200 };
+		static_assert( w.GetIndex() == (1ull << 39) + 7 && w.GetVersion() == 9 && w.GetStorageIndex() == 200 );
+		check( !Small{}.IsValid() );
+		check( Small{0, 0, 0}.IsValid() );
+	}
+	{
+		vecs::HandleSet<> set; //indices 0..999 and colliding indices 1024.., erase every third
+		std::unordered_set<vecs::Handle> reference;
+		for( size_t i=0; i<1000; ++i ) {
+			check( set.insert({i, 1}) );
+			check( set.insert({i + 1024, 2}) );
+			check( !set.insert({i, 1}) );
+			reference.insert(vecs::Handle{i, 1}); reference.insert(vecs::Handle{i + 1024, 2});
+		}
+		for( size_t i=0; i<1000; i += 3 ) { check( set.erase({i, 1}) == 1 ); check( set.erase({i, 1}) == 0 ); reference.erase(vecs::Handle{i, 1}); }
+		check( set.size() == reference.size() );
+		check( !set.contains({1, 2}) );
+		check( set.contains({1025, 2}) );
+		for( auto h : set ) { check( reference.contains(h) ); }
+		set.clear();
+		check( set.empty() );
+		check( !set.contains({1, 1}) );
+		check( set.insert({1, 1}) );
+
+		vecs::HandleMap<std::string> map;
+		map[{5, 0}] = "five";
+		check( map.insert({7, 0}, "seven") );
+		check( !map.insert({7, 0}, "eight") );
+		check( map.find({7, 0})->second == "seven" );
+		check( map.erase({5, 0}) == 1 );
+		check( map.find({5, 0}) == map.end() );
+		check( map.size() == 1 );
+	}
 
 	std::cout << "\x1b[32m passed\n";
 }
 
+struct counted_t { //no default constructor
+	inline static int m_constructed{0};
+	inline static int m_destroyed{0};
+	int m_value;
+	counted_t(int value) : m_value{value} { ++m_constructed; }
+	counted_t(const counted_t& other) : m_value{other.m_value} { ++m_constructed; }
+	counted_t& operator=(const counted_t& other) = default;
+	~counted_t() { ++m_destroyed; }
+};
+
+struct owning_t { //relocatable, but not trivially copyable
+	std::unique_ptr<int> m_ptr;
+	owning_t(int value) : m_ptr{ std::make_unique<int>(value) } {}
+	owning_t(const owning_t& other) : m_ptr{ std::make_unique<int>(*other.m_ptr) } {}
+	owning_t(owning_t&& other) = default;
+	owning_t& operator=(const owning_t& other) { m_ptr = std::make_unique<int>(*other.m_ptr); return *this; }
+	owning_t& operator=(owning_t&& other) = default;
+};
+
+template<>
+struct vecs::is_trivially_relocatable<owning_t> : std::true_type {};
+
 void test_vector() {
 	std::cout << "\x1b[37m testing vector...";
 	{
@@ -71,7 +133,7 @@ void test_vector() {
 			check( vec[0] == 30000 - i - 1); 
 		}
 		check( vec.size() == 29000 );
-		for( int i=0; i<1000; ++i ) { 
+		for( size_t i=0; i<1000; ++i ) { 
 			vec.erase( i ); 
 			check( vec.size() == 29000 - i - 1 ); 
 		}
@@ -94,9 +156,165 @@ void test_vector() {
 		auto newvec = vec.clone();
 		check( newvec->size() == 0 );
 
+		for( int i=0; i<400; ++i ) { check( reinterpret_cast<uintptr_t>(&vec[i << 6]) % vecs::SEGMENT_ALIGNMENT == 0 ); }
+		vecs::Vector<int> vec3{vec2};
+		check( vec3.size() == vec2.size() );
+		for( int i=0; i<10000; ++i ) { check( vec3[i] == vec2[i] ); }
+
 		vecs::VectorBase* vb = &vec;
 		for( int i=0; i<10000; ++i ) { vb->push_back(); }
 	}
+
+	{
+		vecs::SegmentPool pool;
+		vecs::Vector<int> vec(6, &pool);
+		for( int i=0; i<65; ++i ) { vec.push_back( i ); }
+		vec.pop_back(); //keeps the second segment as spare
+		size_t misses = pool.Misses();
+		for( int i=0; i<100; ++i ) { //oscillate around the segment boundary
+			vec.push_back( i );
+			vec.pop_back();
+		}
+		check( pool.Misses() == misses );
+		check( pool.Hits() == 0 );
+
+		for( int i=0; i<1000; ++i ) { vec.push_back( i ); }
+		vec.clear();
+		check( pool.CachedBytes() > 0 );
+		misses = pool.Misses();
+		for( int i=0; i<1000; ++i ) { vec.push_back( i ); }
+		check( pool.Misses() == misses );
+		check( pool.Hits() > 0 );
+		for( int i=0; i<1000; ++i ) { check( vec[i] == i ); }
+
+		vecs::Vector<double> vec2(5, &pool); //same segment size in bytes as the int vector
+		size_t hits = pool.Hits();
+		vec.clear();
+		for( int i=0; i<100; ++i ) { vec2.push_back( (double)i ); }
+		check( pool.Hits() > hits );
+	}
+	{
+		vecs::Vector<int> vec(3);
+		for( int i=0; i<20; ++i ) { vec.push_back( i ); }
+		check( vec.Span(0).size() == 8 );
+		check( vec.Span(5).size() == 3 );
+		check( vec.Span(17).size() == 3 );
+		size_t segments = 0, total = 0;
+		for( auto span : vec.Segments() ) { ++segments; total += span.size(); }
+		check( segments == 3 );
+		check( total == 20 );
+		vec.ForEachSpan( [](std::span<int> span){ for( auto& v : span ) { v *= 2; } } );
+		for( int i=0; i<20; ++i ) { check( vec[i] == 2*i ); }
+	}
+	{
+		vecs::Vector<int> vec(3), vec2(2);
+		for( int i=0; i<20; ++i ) { vec.push_back( i ); }
+		vec2.push_back( -1 );
+		vec2.append_range( &vec, 3, 15 ); //crosses segment boundaries in both vectors
+		check( vec2.size() == 16 );
+		check( vec2[0] == -1 );
+		for( int i=1; i<16; ++i ) { check( vec2[i] == i+2 ); }
+
+		check( vec.erase_range( 2, 5 ) == 15 ); //elements 15..19 fill the hole
+		check( vec.size() == 15 );
+		check( vec[2] == 15 );
+		check( vec[6] == 19 );
+		check( vec[7] == 7 );
+		check( vec.erase_range( 10, 5 ) == 15 ); //nothing to move
+		check( vec.size() == 10 );
+
+		vec.resize( 30 );
+		check( vec.size() == 30 );
+		check( vec[29] == 0 );
+		vec.fill( 5, 20, 7 );
+		check( vec[4] == 17 );
+		check( vec[5] == 7 );
+		check( vec[24] == 7 );
+		check( vec[25] == 0 );
+		vec.resize( 3 );
+		check( vec.size() == 3 );
+		check( vec[2] == 15 );
+
+		vecs::Vector<std::string> strs(2);
+		for( int i=0; i<10; ++i ) { strs.push_back( std::to_string(i) ); }
+		strs.erase_range( 1, 3 );
+		check( strs.size() == 7 );
+		check( strs[1] == "7" );
+		check( strs[3] == "9" );
+		check( strs[4] == "4" );
+	}
+	{
+		vecs::Vector<int> vec(6, nullptr, 2); //segments of 4, 4, 8, 16, 32, 64, 64, ... elements
+		check( vec.capacity() == 4 );
+		for( int i=0; i<1000; ++i ) { vec.push_back( i ); }
+		for( int i=0; i<1000; ++i ) { check( vec[i] == i ); }
+		std::vector<size_t> sizes;
+		for( auto span : vec.Segments() ) { sizes.push_back( span.size() ); }
+		check( sizes.size() == 20 );
+		check( sizes[0] == 4 );
+		check( sizes[1] == 4 );
+		check( sizes[2] == 8 );
+		check( sizes[5] == 64 );
+		check( sizes[19] == 1000 - 15*64 );
+		check( vec.capacity() == 1024 );
+		vec.erase_range( 0, 990 );
+		check( vec.size() == 10 );
+		check( vec[0] == 990 );
+		check( vec.capacity() == 16 );
+		vecs::Vector<int> vec2(6);
+		vec2.append_range( &vec, 0, 10 );
+		check( vec2[9] == 999 );
+		check( vec2.capacity() == 64 );
+
+		check( vecs::SegmentBits<int>(1 << 14) == 12 );
+		check( vecs::SegmentBits<int>(1000) == 7 );
+		check( vecs::SegmentBits<std::array<char, 1 << 15>>(1 << 14) == 1 );
+	}
+	{
+		vecs::Vector<int> vec(20, nullptr, 0, vecs::SegmentMemory::Mapped); //one segment of 4 MB address space
+		for( int i=0; i<1000000; ++i ) { vec.push_back( i ); }
+		check( vec.Span(0).size() == 1000000 );
+		check( &vec[999999] == &vec[0] + 999999 );
+		vec.clear();
+		for( int i=0; i<10; ++i ) { vec.push_back( i ); }
+		check( vec[9] == 9 );
+		for( int i=10; i<(1<<20) + 10; ++i ) { vec.push_back( i ); } //grows into a second mapped segment
+		check( vec[(1<<20) + 9] == (1<<20) + 9 );
+		check( vec.capacity() == 1<<21 );
+	}
+	{
+		static_assert( vecs::is_trivially_relocatable_v<int> && !vecs::is_trivially_relocatable_v<std::string> );
+		vecs::Vector<owning_t> vec(2), vec2(3);
+		for( int i=0; i<10; ++i ) { vec.emplace_back( i ); }
+		check( vec.erase( 2 ) == 9 );
+		check( *vec[2].m_ptr == 9 );
+		check( vec.size() == 9 );
+		vec.swap( 0, 1 );
+		check( *vec[0].m_ptr == 1 );
+		check( *vec[1].m_ptr == 0 );
+		check( vec2.relocate( &vec, 3 ) == 8 ); //moves 3 to vec2, 8 fills the hole
+		check( *vec2[0].m_ptr == 3 );
+		check( *vec[3].m_ptr == 8 );
+		check( vec.size() == 8 );
+		vec.erase_range( 0, 3 );
+		check( vec.size() == 5 );
+		check( *vec[0].m_ptr == 5 );
+	}
+	{
+		vecs::Vector<counted_t> vec;
+		for( int i=0; i<100; ++i ) { vec.emplace_back( i ); }
+		check( counted_t::m_constructed == 100 ); //constructed once in place, no default construction
+		check( counted_t::m_destroyed == 0 );
+		vec.erase( 10 );
+		check( vec[10].m_value == 99 );
+		check( counted_t::m_destroyed == 1 );
+		vec.clear();
+		check( counted_t::m_destroyed == counted_t::m_constructed );
+
+		vecs::Registry system;
+		auto handle = system.Insert( counted_t{5}, 1 );
+		check( system.Get<counted_t>(handle).m_value == 5 );
+	}
 	std::cout << "\x1b[32m passed\n";
 }
 
@@ -142,12 +360,163 @@ void test_slotmap() {
 		for( int i=0; i<10000; ++i ) { check( sm[handles[i]].m_value == i ) ; }
 
 	}
+	{
+		vecs::SlotMap<int> sm(0,20); //memory is reserved, but no slot is written
+		check( sm.HighWater() == 0 );
+		sm.Clear();
+		auto [h1, v1] = sm.Insert(1);
+		auto [h2, v2] = sm.Insert(2);
+		check( h1.GetIndex() == 0 );
+		check( h2.GetIndex() == 1 );
+		check( sm.HighWater() == 2 );
+		sm.Erase( h1 );
+		auto [h3, v3] = sm.Insert(3);
+		check( h3.GetIndex() == 0 ); //free slots are reused first
+		check( h3.GetVersion() == 1 );
+		check( sm.HighWater() == 2 );
+		sm.Reserve( 100000 );
+		for( int i=0; i<1000; ++i ) { sm.Insert(i); }
+		check( sm.HighWater() == 1002 );
+		check( sm.Size() == 1002 );
+	}
+	{
+		vecs::SlotMap<int> sm(0,6); //the lowest free slots are used first
+		std::vector<vecs::Handle> handles;
+		for( int i=0; i<10000; ++i ) { handles.push_back( sm.Insert(i).first ); }
+		for( int i=0; i<10000; ++i ) { if( i % 10 != 0 ) sm.Erase(handles[i]); } //despawn 90%
+		for( size_t i=0; i<1000; ++i ) { check( sm.Insert((int)i).first.GetIndex() == i + i / 9 + 1 ); } //1..9, 11..19, ...
+		check( sm.Size() == 2000 );
+		sm.Clear();
+		for( size_t i=0; i<100; ++i ) { check( sm.Insert((int)i).first.GetIndex() == i ); }
+		for( int i=0; i<100; ++i ) { handles[i] = sm.Insert(i).first; }
+		for( int i=0; i<100; ++i ) { sm.Erase(handles[i]); }
+		check( sm.ShrinkToFit() == 10000 - 100 );
+		check( sm.HighWater() == 100 );
+		auto [h, v] = sm.Insert(5);
+		check( h.GetIndex() == 100 );
+		check( h.GetVersion() >= 2 );
+		check( !sm.Exists(handles[0]) );
+	}
+	{
+		vecs::SlotMap<int> sm(0,6); //versions are validated without touching the values
+		auto [h1, v1] = sm.Insert(1);
+		auto [h2, v2] = sm.Insert(2);
+		sm.Erase( h1 );
+		check( !sm.Exists(h1) );
+		check( sm.Exists(h2) );
+		check( sm.Version(h1) == 1 );
+		std::array<vecs::Handle, 3> hs{ h1, h2, vecs::Handle{100, 0, 0} };
+		std::array<uint8_t, 3> ok{};
+		check( sm.Validate(hs, ok) == 1 );
+		check( ok[0] == 0 );
+		check( ok[1] == 1 );
+		check( ok[2] == 0 );
+
+		std::array<vecs::Handle, 4> bulk; //takes the free slot first, then appends
+		sm.InsertBulk(bulk, 7);
+		check( bulk[0].GetIndex() == 0 );
+		check( bulk[0].GetVersion() == 1 );
+		check( bulk[3].GetIndex() == 4 );
+		check( sm[bulk[3]].m_value == 7 );
+		check( sm.Size() == 5 );
+	}
+	{
+		vecs::ConcurrentSlotMap<int> sm(0, 6, 4); //the first segments have 16 slots
+		auto [h1, v1] = sm.Insert(1);
+		auto [h2, v2] = sm.Insert(2);
+		check( sm[h2].m_value == 2 );
+		check( sm.Exists(h1) );
+		check( sm.Erase(h1) ); //a handle can be erased only once
+		check( !sm.Erase(h1) );
+		check( !sm.Exists(h1) );
+		check( sm.Size() == 1 );
+		auto [h3, v3] = sm.Insert(3);
+		check( h3.GetIndex() == 0 );
+		check( h3.GetVersion() == 1 );
+		check( sm.HighWater() == 2 );
+
+		std::vector<std::thread> threads;
+		for( int t = 0; t < 4; ++t ) {
+			threads.emplace_back( [&sm]() {
+				std::vector<vecs::Handle> handles;
+				for( int round = 0; round < 10; ++round ) {
+					for( int i = 0; i < 1000; ++i ) { handles.push_back( sm.Insert(i).first ); }
+					for( auto& h : handles ) { sm.Erase(h); }
+					handles.clear();
+				}
+			} );
+		}
+		for( auto& thread : threads ) { thread.join(); }
+		check( sm.Size() == 2 );
+		check( sm.HighWater() <= 4002 );
+		check( sm.Exists(h2) );
+		check( sm.Exists(h3) );
+
+		std::array<vecs::Handle, 8> bulk;
+		sm.InsertBulk(bulk, 5);
+		check( sm.Size() == 10 );
+		check( sm[bulk[7]].m_value == 5 );
+		check( sm.Exists(bulk[0]) );
+	}
+	{
+		vecs::ConcurrentSlotMap<int, vecs::HandleT<8,16,8>> sm(0, 0, 2); //8 index bits, segments of 4, 4, 8, ... slots
+		std::array<vecs::HandleT<8,16,8>, 200> bulk;
+		check( sm.InsertBulk(bulk, 1) == 200 );
+		size_t inserted = 0;
+		for( int i = 0; i < 100; ++i ) { if( sm.TryInsert(i) ) ++inserted; }
+		check( inserted == 55 ); //index 255 ends the free list, the slot map is full, inserting reports failure
+		check( sm.HighWater() == 255 );
+		check( sm.InsertBulk(bulk, 2) == 0 );
+		check( sm.Erase(bulk[5]) );
+		auto slot = sm.TryInsert(5);
+		check( slot.has_value() );
+		check( slot->first.GetIndex() == 5 );
+		check( sm.Size() == 255 );
+	}
+	{
+		using Wide = vecs::HandleT<40,16,8>; //indices beyond 32 bits must not alias small indices
+		vecs::ConcurrentSlotMap<int, Wide> sm(0, 0);
+		vecs::SlotMap<int, Wide> seq(0, 0);
+		auto [h, v] = sm.Insert(1);
+		auto [hs, vs] = seq.Insert(1);
+		Wide alias{ (size_t{1} << 32) + h.GetIndex(), h.GetVersion(), 0 };
+		check( !sm.Exists(alias) );
+		check( !sm.Erase(alias) );
+		check( sm.Exists(h) );
+		check( !seq.Exists(alias) );
+		check( seq.Exists(hs) );
+		check( sm.Capacity() == (size_t{1} << 40) - 1 );
+		check( seq.Capacity() == size_t{1} << 40 );
+	}
+	{
+		vecs::SlotMapShards<vecs::ConcurrentSlotMap<int>> shards(4, 6); //each thread inserts into its home shard
+		auto [h1, v1] = shards.Insert(1);
+		auto [h2, v2] = shards.Insert(2);
+		check( h1.GetStorageIndex() == shards.Home() );
+		check( h2.GetStorageIndex() == shards.Home() );
+		auto [h3, v3] = shards.InsertAt(shards.Home() + 1, 3);
+		check( h3.GetStorageIndex() == ((shards.Home() + 1) & 3) );
+		check( shards[h3].m_value == 3 );
+		check( shards.Size() == 3 );
+		shards.Erase(h3);
+		check( !shards.Exists(h3) );
+		check( shards.Exists(h1) );
+		check( shards.Size() == 2 );
+	}
 	std::cout << "\x1b[32m passed\n";
 }
 
 void test_archetype() {
 	std::cout << "\x1b[37m testing archetype...";
 
+	{
+		struct first_t {}; struct second_t {}; //dense type IDs in the order of first use
+		size_t id = vecs::TypeId<first_t>();
+		check( vecs::TypeId<second_t>() == id + 1 );
+		check( vecs::TypeId<const first_t&>() == id );
+		check( vecs::TypeIdCount() == id + 2 );
+		check( vecs::Type<first_t>() == std::type_index(typeid(first_t)).hash_code() );
+	}
 	{
 		vecs::Archetype arch;
 		arch.AddComponent<int>();
@@ -203,6 +572,53 @@ void test_archetype() {
 
 		arch.Erase( 0 );
 		check( arch.Size() == 0 );
+
+		check( arch.Has<int>() );
+		check( arch.Has<const std::string&>() );
+		check( !arch.Has<short>() );
+		check( arch.Has(vecs::Type<char>()) );
+		check( arch.Signature().count() == 6 );
+		check( std::ranges::is_sorted(arch.Types()) );
+		arch.AddType(12345); //a tag
+		check( arch.Has(12345) );
+		check( arch.Signature().test(vecs::TagId(12345)) );
+		check( arch.Types().size() == 7 );
+	}
+
+	{
+		vecs::ArchetypeDirectory<vecs::Archetype> directory;
+		std::vector<vecs::Archetype*> archs;
+		for( size_t bits = 0; bits < 4096; ++bits ) { //all combinations of 12 tags
+			auto arch = std::make_unique<vecs::Archetype>();
+			for( size_t i = 0; i < 12; ++i ) { if( bits & (1ull << i) ) arch->AddType(54321 + i); }
+			archs.push_back( directory.Insert(std::move(arch)) );
+		}
+		check( directory.Size() == 4096 );
+		bool found = true;
+		for( auto arch : archs ) { found = found && directory.Find(arch->Signature()) == arch; }
+		check( found );
+		check( directory.Find(vecs::TypeSignature<int>()) == nullptr );
+		check( (*directory.begin()).get() == archs[0] );
+		check( directory.WithType(vecs::TagId(54321)).size() == 2048 );
+		check( directory.WithType(vecs::TagId(54321))[0] == archs[1] );
+	}
+
+	{
+		vecs::Archetype from, to; //edges for single types are indexed by the type ID, edges for packs by their signatures
+		from.AddComponent<int>();
+		to.AddComponent<int>();
+		to.AddComponent<float>();
+		auto id = vecs::TypeId<float>();
+		check( from.FindEdge(id, true) == nullptr );
+		from.AddEdge(id, true, &to);
+		auto edge = from.FindEdge(id, true);
+		check( edge != nullptr );
+		check( edge->m_target == &to );
+		check( from.FindEdge(id, false) == nullptr );
+		check( from.FindEdge(vecs::TypeSignature<float>(), {}) == nullptr );
+		from.AddEdge(vecs::TypeSignature<float, short>(), {}, &to);
+		check( from.FindEdge(vecs::TypeSignature<float, short>(), {}) != nullptr );
+		check( from.FindEdge({}, vecs::TypeSignature<float, short>()) == nullptr );
 	}
 
 	{
@@ -311,6 +727,40 @@ void test_archetype() {
 		check( arch.Get<char>(1) == 'b' );
 		check( arch.Get<double>(1) == 4.0 );
 
+		auto [index2, handle2] = arch2.Move( arch, 0 ); //drops the string
+		check( arch2.Size() == 1 );
+		check( arch.Size() == 1 );
+		check( index2 == 0 );
+		check( handle2 == vecs::Handle{2,3} );
+		check( arch2.Get<int>(0) == 1 );
+		check( arch.Get<int>(0) == 2 );
+		auto [index3, handle3] = arch.Move( arch2, 0 ); //reuses the cached plan
+		check( index3 == 1 );
+		check( handle3 == vecs::Handle{} );
+		check( arch.Get<double>(1) == 3.0 );
+
+		vecs::Archetype arch5;
+		arch5.AddComponent<int>();
+		arch5.AddComponent<double>();
+		arch5.UseChunks( 1024 );
+		auto store = arch5.GetChunkStore();
+		check( store->Rows() == 32 );
+		check( store->Number() == 0 );
+		for( int i=0; i<40; ++i ) { arch5.Insert( vecs::Handle{(uint32_t)i, 1}, i, (double)i ); }
+		check( store->Number() == 2 );
+		check( store->GetHeader(0).m_count == 32 );
+		check( store->GetHeader(1).m_count == 8 );
+		size_t version = store->GetHeader(0).m_version;
+		arch5.Put( 3, 100 );
+		check( arch5.Get<int>(3) == 100 );
+		check( store->GetHeader(0).m_version == version + 1 );
+		check( arch5.Erase( 0 ) == vecs::Handle{39, 1} );
+		check( arch5.Get<int>(0) == 39 );
+		check( store->GetHeader(1).m_count == 7 );
+		arch5.Clear();
+		check( store->Number() == 1 ); //the vectors keep their first segment
+		check( store->GetHeader(0).m_count == 0 );
+
 		vecs::Archetype arch3;
 		arch3.Clone( arch, std::vector<size_t>{} );
 		check( arch3.Size() == 0 );
@@ -0,0 +1,72 @@
+//Type IDs are shared by the whole process, so running out of them is tested in its own program,
+//with few IDs and with asserts disabled like in a release build.
+#define NDEBUG
+#define VECS_MAX_TYPES 8
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "VECS.h"
+
+#ifdef __linux__
+#include <sys/wait.h>
+#endif
+
+
+void check( bool b, std::string_view msg = "" ) {
+	if( b ) {
+		//std::cout << "\x1b[32m passed\n";
+	} else {
+		std::cout << "\x1b[31m failed: " << msg << "\n";
+		exit(1);
+	}
+}
+
+void test_type_ids() {
+	std::cout << "\x1b[37m testing running out of type IDs...";
+
+	vecs::Registry system;
+	auto handle = system.Insert(1, 2.0f);
+	size_t tag = 1000;
+	while( vecs::TypeIdCount() < VECS_MAX_TYPES ) { check( system.AddTags(handle, tag++) ); }
+	check( !system.AddTags(handle, tag) ); //no IDs left, the entity keeps its archetype
+	check( !system.AddTags(handle, tag, tag + 1) );
+	check( vecs::TypeIdCount() == VECS_MAX_TYPES );
+	check( system.Has(handle, 1000ul) );
+	check( !system.Has(handle, tag) );
+	check( system.Get<int>(handle) == 1 );
+	system.EraseTags(handle, tag);
+	system.EraseTags(handle, 1000ul);
+	check( !system.Has(handle, 1000ul) );
+
+	size_t number = 0;
+	for( [[maybe_unused]] auto [h, i] : system.template GetView<vecs::Handle, int>({tag}) ) { ++number; }
+	check( number == 0 );
+
+	auto other = system.Insert(3, 4.0f); //known component types still work
+	check( other.IsValid() );
+	check( system.Get<float>(other) == 4.0f );
+	check( system.Size() == 2 );
+
+#ifdef __linux__
+	std::cout.flush();
+	pid_t pid = fork();
+	if( pid == 0 ) { //a new component type ends the program instead of throwing with a taken slot
+		[[maybe_unused]] auto h = system.Insert(5.0);
+		_exit(0);
+	}
+	int status = 0;
+	waitpid(pid, &status, 0);
+	check( WIFEXITED(status) );
+	check( WEXITSTATUS(status) != 0 );
+	check( system.Size() == 2 );
+#endif
+
+	std::cout << "\x1b[32m passed\n";
+}
+
+int main() {
+	std::cout << "testing VECS type IDs...\n";
+	test_type_ids();
+}
@@ -255,6 +255,16 @@ int test1() {
 	        if(boolprint) std::cout << "Handle: "<< handle << " int: " << i << " float: " << f << std::endl;
 		}
 
+		size_t spanned = 0;
+		system.template GetView<int, float>().ForEachSpan( [&](std::span<int> is, std::span<float> fs) {
+			check( is.size() == fs.size() );
+			for( size_t k = 0; k < is.size(); ++k ) { fs[k] = (float)is[k]; }
+			spanned += is.size();
+		});
+		size_t counted = 0;
+		for( auto [i, f] : system.template GetView<int&, float>() ) { check( (float)i() == f ); ++counted; }
+		check( spanned == counted );
+		check( counted > 0 );
 		check( system.Size() > 0 );
 	    system.Clear();
 	    check( system.Size() == 0 );
@@ -334,6 +344,21 @@ size_t test_iterate( vecs::Registry& system, int m ) {
 	return std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
 }
 
+size_t test_iterate_values( vecs::Registry& system, int ) {
+
+	auto t1 = std::chrono::high_resolution_clock::now();
+
+	double sum = 0.0;
+	for( auto [handle, i, f] : system.template GetView<vecs::Handle, int, float>() ) { //component maps are looked up once per archetype
+		sum += i + f;
+	}
+	check( sum >= 0.0 );
+
+	auto t2 = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+}
+
 
 void test3( std::string name, bool insert, auto&& job ) {
 
@@ -364,6 +389,18 @@ void test3( std::string name, bool insert, auto&& job ) {
 		if(boolprint) std::cout << "Size: " << system.Size() << " us: " << duration << " us/entity: " << (double)duration/(double)num << std::endl;
 	}
 
+	{
+		if(boolprint) std::cout << "test 3.3 sequential chunks " + name << std::endl;
+		vecs::Registry system{vecs::CHUNK_BYTES};
+		if(insert) test_insert(system, num);
+		duration = job(system, num);
+		if(boolprint) std::cout << "Size: " << system.Size() << " us: " << duration << " us/entity: " << (double)duration/(double)num << std::endl;
+		system.Clear();
+		if(insert) test_insert(system, num);
+		duration = job(system, num);
+		if(boolprint) std::cout << "Size: " << system.Size() << " us: " << duration << " us/entity: " << (double)duration/(double)num << std::endl;
+	}
+
 }
 
 
@@ -425,7 +462,7 @@ void test5() {
 	if(boolprint) std::cout << "test 5 parallel" << std::endl;
 
 	using system_t = vecs::Registry;
-	using handles_t = std::set<vecs::Handle>;
+	using handles_t = vecs::HandleSet<>;
 	system_t system;
 
 	std::random_device rd;
@@ -487,7 +524,7 @@ void test5() {
 
 	int num = 1000000;
 	auto work = [&](auto& system) {
-		std::set<vecs::Handle> hs;
+		handles_t hs;
 
 		for( int i=0; i<num; ++i ) {
 			size_t idx = std::min( (size_t)(dis(gen)*jobs.size()), jobs.size()-1);
@@ -515,11 +552,242 @@ void test5() {
 }
 
 
+struct mapped_t { 
+	int i; 
+};
+
+template<>
+struct vecs::SegmentTraits<mapped_t> : vecs::SegmentTraits<void> {
+	static constexpr vecs::SegmentMemory memory = vecs::SegmentMemory::MappedHugePages;
+	static constexpr size_t mappedBytes = 1ull << 24;
+};
+
+void test_mapped() {
+	vecs::Registry system;
+	std::vector<vecs::Handle> handles;
+	for( int i=0; i<100000; ++i ) { handles.push_back( system.Insert(mapped_t{i}, (float)i) ); }
+	for( int i=0; i<100000; i+=2 ) { system.Erase(handles[i]); }
+	for( int i=1; i<100000; i+=2 ) { check( system.Get<mapped_t>(handles[i]).i == i ); }
+	size_t spans = 0, count = 0;
+	system.template GetView<mapped_t>().ForEachSpan( [&](std::span<mapped_t> ms) { ++spans; count += ms.size(); } );
+	check( count == 50000 );
+	if constexpr (vecs::MAPPED_MEMORY) { check( spans == 1 ); } //else heap segments of the normal size
+}
+
+
+void test_chunks() {
+	vecs::Registry system{1024};
+	std::vector<vecs::Handle> handles;
+	for( int i=0; i<100; ++i ) { handles.push_back( system.Insert(i, (float)i, (double)i) ); }
+
+	std::vector<size_t> sizes;
+	system.template GetView<int, float>().ForEachSpan( [&](std::span<int> is, std::span<float> fs) {
+		check( std::abs( (char*)fs.data() - (char*)is.data() ) < 1024 ); //same chunk
+		sizes.push_back( is.size() );
+	});
+	check( sizes.size() == 4 ); //(8 + 4 + 4 + 8) * 32 bytes plus header fit into 1 KB
+	check( sizes[0] == 32 );
+	check( sizes[3] == 4 );
+
+	for( int i=0; i<100; i+=2 ) { system.Erase(handles[i]); }
+	for( int i=1; i<100; i+=2 ) { system.AddTags(handles[i], 1ul); }
+	for( int i=1; i<100; i+=2 ) { check( system.Get<int>(handles[i]) == i ); check( system.Get<double>(handles[i]) == (double)i ); }
+
+	size_t spanned = 0;
+	system.template GetView<int, double>().ForEachSpan( [&](std::span<int> is, std::span<double> ds) {
+		check( is.size() <= 32 );
+		for( size_t k = 0; k < is.size(); ++k ) { check( (double)is[k] == ds[k] ); }
+		spanned += is.size();
+	});
+	check( spanned == 50 );
+	system.Clear();
+	check( system.Size() == 0 );
+}
+
+void test_bulk() {
+	vecs::Registry system;
+	auto h0 = system.Insert(-1, -1.0f);
+	auto handles = system.InsertBulk<int, float>( 1000, [](size_t i){ return std::make_tuple((int)i, (float)i); } );
+	check( handles.size() == 1000 );
+	check( system.Size() == 1001 );
+	for( int i=0; i<1000; ++i ) { check( system.Get<int>(handles[i]) == i ); check( system.Get<float>(handles[i]) == (float)i ); }
+
+	std::vector<int> is(100, 7);
+	std::vector<double> ds(100, 8.0);
+	auto more = system.InsertBulk<int, double>( std::span<const int>{is}, std::span<const double>{ds} );
+	check( more.size() == 100 );
+	check( system.Get<int>(more[99]) == 7 );
+	check( system.Get<double>(more[99]) == 8.0 );
+
+	std::vector<vecs::Handle> erase;
+	for( int i=0; i<1000; i+=2 ) { erase.push_back(handles[i]); }
+	erase.push_back(handles[0]); //duplicates and erased entities are ignored
+	system.EraseBulk(erase);
+	system.EraseBulk(erase);
+	check( system.Size() == 601 );
+	check( system.Exists(h0) );
+	check( system.Get<int>(h0) == -1 );
+	for( int i=0; i<1000; ++i ) { check( system.Exists(handles[i]) == (i % 2 == 1) ); }
+	for( int i=1; i<1000; i+=2 ) { check( system.Get<int>(handles[i]) == i ); check( system.Get<float>(handles[i]) == (float)i ); }
+
+	auto reused = system.InsertBulk<int, float>( 600, [](size_t i){ return std::make_tuple((int)i, 0.0f); } );
+	check( system.Size() == 1201 );
+	check( system.Get<int>(reused[599]) == 599 );
+	for( int i=1; i<1000; i+=2 ) { check( system.Get<int>(handles[i]) == i ); }
+
+	vecs::Registry chunked{1024};
+	auto ch = chunked.InsertBulk<int, double>( 100, [](size_t i){ return std::make_tuple((int)i, (double)i); } );
+	chunked.EraseBulk( std::span<const vecs::Handle>{ch}.subspan(0, 50) );
+	for( int i=50; i<100; ++i ) { check( chunked.Get<int>(ch[i]) == i ); check( chunked.Get<double>(ch[i]) == (double)i ); }
+}
+
+void test_shrink() {
+	vecs::Registry system; //despawn 90% and respawn, the new entities take the lowest free slots
+	auto handles = system.InsertBulk<int>( 10000, [](size_t i){ return std::make_tuple((int)i); } );
+	std::vector<vecs::Handle> erase;
+	for( int i=0; i<10000; ++i ) { if( i % 10 != 0 || i >= 5000 ) erase.push_back(handles[i]); }
+	system.EraseBulk(erase);
+	auto respawned = system.InsertBulk<int>( 4000, [](size_t i){ return std::make_tuple(-(int)i); } );
+	size_t highest = 0;
+	for( auto& h : respawned ) { highest = std::max(highest, h.GetIndex()); }
+	check( highest < 4500 ); //4990 is the last live entity
+	check( system.ShrinkToFit() == 10000 - 4991 );
+	check( !system.Exists(handles[9999]) );
+	check( system.Get<int>(handles[4490]) == 4490 );
+	check( system.Get<int>(respawned[3999]) == -3999 );
+	auto more = system.InsertBulk<int>( 10, [](size_t){ return std::make_tuple(1); } );
+	check( more[0].GetIndex() == 4445 );
+	check( system.Size() == 4510 );
+}
+
+void test_handle_layout() {
+	using Small = vecs::HandleT<20,10,2>; //4 byte handles, e.g. for components holding many entity references
+	struct parent_t { Small m_parent; };
+	vecs::RegistryT<Small> system;
+	std::vector<Small> handles;
+	for( int i=0; i<100; ++i ) { handles.push_back( system.Insert(i, parent_t{}) ); }
+	for( int i=1; i<100; ++i ) { system.Put(handles[i], parent_t{handles[i-1]}); } //a chain of references
+	check( system.Get<parent_t>(handles[99]).m_parent == handles[98] );
+	check( system.Get<int>(system.Get<parent_t>(handles[5]).m_parent) == 4 );
+	for( int round=0; round<1100; ++round ) { //versions wrap around after 1024 erasures
+		system.Erase(handles[0]);
+		check( !system.Exists(handles[0]) );
+		handles[0] = system.Insert(0, parent_t{});
+		check( system.Exists(handles[0]) );
+		check( handles[0].GetIndex() == 0 );
+	}
+	size_t sum = 0;
+	for( auto [handle, i] : system.template GetView<Small, int>() ) { sum += i; }
+	check( sum == 99 * 100 / 2 );
+
+	vecs::RegistryT<Small> full; //fill all slot maps up to the largest index
+#ifdef REGISTRYTYPE_SEQUENTIAL
+	const size_t capacity = vecs::SlotMap<int, Small>::Capacity();
+#else
+	const size_t capacity = 4 * vecs::ConcurrentSlotMap<int, Small>::Capacity();
+#endif
+	auto all = full.template InsertBulk<int>( capacity, [](size_t i){ return std::make_tuple((int)i); } );
+	check( all.size() == capacity );
+	check( std::ranges::any_of(all, [](Small h){ return h.GetIndex() == (size_t)Small::INDEX_MASK - 1; }) );
+	check( std::ranges::all_of(all, [](Small h){ return h.GetIndex() <= (size_t)Small::INDEX_MASK; }) );
+	check( full.Get<int>(all.back()) == (int)capacity - 1 );
+	check( !full.Insert(1).IsValid() );
+
+	vecs::RegistryT<vecs::HandleT<40,16,8>> wide;
+	auto h = wide.Insert(1.0);
+	check( wide.Get<double>(h) == 1.0 );
+	check( sizeof(h) == 8 );
+}
+
+void test_full_slot_maps() {
+	using Tiny = vecs::HandleT<12,16,4>; //4096 slots per slot map
+	vecs::RegistryT<Tiny> system;
+#ifdef REGISTRYTYPE_SEQUENTIAL
+	const size_t capacity = vecs::SlotMap<int, Tiny>::Capacity();
+#else
+	const size_t capacity = 16 * vecs::ConcurrentSlotMap<int, Tiny>::Capacity(); //a full home shard spills to the next shard
+#endif
+	auto handles = system.template InsertBulk<int>( capacity - 10, [](size_t i){ return std::make_tuple((int)i); } );
+	check( handles.size() == capacity - 10 );
+	for( int i=0; i<10; ++i ) { handles.push_back( system.Insert(i) ); }
+	check( std::ranges::all_of(handles, [&](Tiny h){ return system.Exists(h); }) );
+	check( system.Size() == capacity );
+	check( !system.Insert(1).IsValid() ); //all slot maps are full
+	check( system.template InsertBulk<int>( 5, [](size_t i){ return std::make_tuple((int)i); } ).empty() );
+	system.Erase(handles[7]);
+	auto handle = system.Insert(7);
+	check( handle.IsValid() );
+	check( system.Get<int>(handle) == 7 );
+	check( system.Size() == capacity );
+}
+
+void test_edges() {
+	vecs::Registry system; //adding and removing the same components and tags again follows the cached edges
+	struct burning_t { int m_ticks; };
+	std::vector<vecs::Handle> handles;
+	for( int i=0; i<100; ++i ) { handles.push_back( system.Insert(i, (float)i) ); }
+	for( int round=0; round<10; ++round ) {
+		for( int i=0; i<100; i += 2 ) { system.Put(handles[i], burning_t{round}); system.AddTags(handles[i], 7ul); }
+		for( int i=0; i<100; i += 2 ) { check( system.Get<burning_t>(handles[i]).m_ticks == round ); check( system.Has(handles[i], 7ul) ); }
+		for( int i=0; i<100; i += 4 ) { system.Erase<burning_t>(handles[i]); system.EraseTags(handles[i], 7ul); }
+	}
+	size_t burning = 0;
+	for( auto [handle, i, f] : system.template GetView<vecs::Handle, int, float>() ) { check( f == (float)i ); check( handles[i] == handle ); }
+	for( auto [i, b] : system.template GetView<int, burning_t>({7}) ) { check( i % 4 == 2 ); ++burning; }
+	check( burning == 25 );
+	check( !system.Has<burning_t>(handles[0]) );
+	check( !system.Has(handles[4], 7ul) );
+}
+void test_tag_ids() {
+	vecs::Registry system; //only adding tags hands out IDs, queries and erasing unknown tags do not
+	auto handle = system.Insert(1, 2.0f);
+	check( system.AddTags(handle, 1001ul) );
+	const size_t ids = vecs::TypeIdCount();
+	for( size_t tag = 100000; tag < 100000 + 2 * VECS_MAX_TYPES; ++tag ) {
+		size_t yes = 0, no = 0;
+		for( [[maybe_unused]] auto [h, i] : system.template GetView<vecs::Handle, int>({tag}) ) { ++yes; }
+		for( [[maybe_unused]] auto [h, i] : system.template GetView<vecs::Handle, int>({1001}, {tag}) ) { ++no; }
+		check( yes == 0 );
+		check( no == 1 );
+		check( !system.Has(handle, tag) );
+		system.EraseTags(handle, tag);
+	}
+	check( vecs::TypeIdCount() == ids );
+	check( system.Has(handle, 1001ul) );
+	check( system.Get<int>(handle) == 1 );
+}
+
+void test_prefabs() {
+	vecs::Registry system; //packs in any order and with references share the archetype
+	int i = 1;
+	auto h1 = system.Insert(i, 2.0f);
+	auto h2 = system.Insert(3.0f, 4);
+	auto hb = system.InsertBulk<float, int>( 10, [](size_t n){ return std::make_tuple((float)n, (int)n); } );
+	check( system.Types(h1) == system.Types(h2) );
+	check( system.Types(h1) == system.Types(hb[9]) );
+	check( vecs::PackId<int&, float>() == vecs::PackId<int, float>() );
+	size_t number = 0;
+	for( [[maybe_unused]] auto [i, f] : system.template GetView<int, float>() ) { ++number; }
+	check( number == 12 );
+}
+
 void test_vecs() {
 	test1();
+	test_chunks();
+	test_mapped();
+	test_bulk();
+#ifdef REGISTRYTYPE_SEQUENTIAL
+	test_shrink(); //the lock free slot map neither reuses lowest slots first nor shrinks
+#endif
+	test_handle_layout();
+	test_full_slot_maps();
+	test_edges();
+	test_tag_ids();
+	test_prefabs();
 	
 	test3( "Insert", false, [&](auto& system, int num){ return test_insert(system, num); } );
 	test3( "Iterate", true, [&](auto& system, int num){ return test_iterate(system, num); } );
+	test3( "Iterate values", true, [&](auto& system, int num){ return test_iterate_values(system, num); } );
 	test3( "Insert + Iterate", false, [&](auto& system, int num){ return test_insert_iterate(system, num); } );
 
 	//test4( "Insert", false, [&](auto& system, int num){ return test_insert(system, num); } );